@@ -0,0 +1,113 @@
+#pragma once
+// ===================== BTC ローソク足（逐次集計） =====================
+// 価格が届くたびに 1分 / 15分 / 1時間 の OHLC リングへ畳み込む。確保なし・1更新 O(1)。
+// 取得が途切れた区間は直前の終値で平らな足を埋める（最大でリング長まで）。
+// rev は足が確定した時か、進行中の足の OHLC が変わった時だけ進む（チャート再描画の判定用）。
+// 時刻は UNIX 秒（足の境界を壁時計に合わせる）。Arduino 非依存。
+#include <stdint.h>
+#include <math.h>
+
+struct Candle {
+  float o, h, l, c; // BTC/JPY（float でも 1600万円台で 1〜2円刻み。表示・変化率には十分）
+};
+
+template <uint32_t PERIOD_S, int N>
+class CandleSeries {
+ public:
+  static const uint32_t PERIOD = PERIOD_S;
+  static const int      CAP    = N;
+
+  // 戻り値 = rev が進んだか
+  bool add(uint32_t t, float p) {
+    uint32_t b = t / PERIOD_S;
+    if (count_ == 0) {
+      head_ = 0; count_ = 1; bucket_ = b;
+      c_[0].o = c_[0].h = c_[0].l = c_[0].c = p;
+      rev_++;
+      return true;
+    }
+    if (b <= bucket_) { // 同じ足（時刻が戻った場合も進行中の足に入れる）
+      Candle& k = c_[head_];
+      if (p == k.c) return false;
+      k.c = p;
+      if (p > k.h) k.h = p;
+      if (p < k.l) k.l = p;
+      rev_++;
+      return true;
+    }
+    // 足の確定。空いた区間は平らな足で埋める
+    const float last = c_[head_].c;
+    uint32_t gap = b - bucket_ - 1;
+    if (gap > (uint32_t)N) gap = N;
+    while (gap--) push(last, last, last, last);
+    push(p, p, p, p);
+    bucket_ = b;
+    closes_++;
+    rev_++;
+    return true;
+  }
+
+  int      count()  const { return count_; }
+  uint32_t rev()    const { return rev_; }
+  uint32_t closes() const { return closes_; }
+  // i = 0 が最古、count()-1 が進行中の足
+  const Candle& at(int i) const { return c_[(head_ + N - (count_ - 1) + i) % N]; }
+  const Candle& live()    const { return c_[head_]; }
+
+ private:
+  void push(float o, float h, float l, float c) {
+    head_ = (head_ + 1) % N;
+    Candle& k = c_[head_];
+    k.o = o; k.h = h; k.l = l; k.c = c;
+    if (count_ < N) count_++;
+  }
+
+  Candle   c_[N];
+  int      head_   = 0;
+  int      count_  = 0;
+  uint32_t bucket_ = 0; // 進行中の足の t / PERIOD
+  uint32_t rev_    = 0;
+  uint32_t closes_ = 0;
+};
+
+enum CandleTf : uint8_t { TF_1M = 0, TF_15M, TF_1H, TF_COUNT };
+static const char* const CANDLE_TF_LABELS[TF_COUNT] = {"1m", "15m", "1h"};
+
+// 3本まとめて約3.3KB
+struct BtcCandles {
+  CandleSeries<60,   60> m1;  // 1時間分
+  CandleSeries<900,  96> m15; // 24時間分（24h変化率もここから）
+  CandleSeries<3600, 48> h1;  // 2日分
+
+  void add(uint32_t t, double price) {
+    const float p = (float)price;
+    m1.add(t, p); m15.add(t, p); h1.add(t, p);
+  }
+
+  uint32_t rev(int tf) const {
+    return tf == TF_1M ? m1.rev() : tf == TF_15M ? m15.rev() : h1.rev();
+  }
+
+  // 直近24時間の変化率(%)。15分足の最古の始値と比較（15分単位）。24時間分たまるまでは NaN
+  float change24hPct() const {
+    if (m15.count() < m15.CAP) return NAN;
+    const float o = m15.at(0).o;
+    return o > 0.0f ? (m15.live().c - o) / o * 100.0f : NAN;
+  }
+};
+
+// 描画用：tf の直近 maxN 本を out に古い順でコピー。戻り値 = 本数
+static inline int candleTail(const BtcCandles& cs, int tf, Candle* out, int maxN) {
+  int n = 0;
+  switch (tf) {
+    case TF_1M:  n = cs.m1.count();  break;
+    case TF_15M: n = cs.m15.count(); break;
+    default:     n = cs.h1.count();  break;
+  }
+  int k = n < maxN ? n : maxN;
+  for (int i = 0; i < k; i++) {
+    int j = n - k + i;
+    out[i] = (tf == TF_1M) ? cs.m1.at(j) : (tf == TF_15M) ? cs.m15.at(j) : cs.h1.at(j);
+  }
+  return k;
+}
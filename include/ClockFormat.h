@@ -0,0 +1,51 @@
+#pragma once
+// ===================== 時計表示テキスト（差分更新） =====================
+// 秒が1つ進んだだけなら秒の2桁だけ書き換える。分/時は変わった時だけ、日付は日が変わった時だけ。
+// strftime / String を毎回作らないので、秒の切り替わりに合わせた再描画を軽くできる。
+#include <stdint.h>
+#include <time.h>
+
+struct ClockText {
+  char      hms[9]  = "--:--:--";   // "HH:MM:SS"
+  char      ymd[11] = "----/--/--"; // "YYYY/MM/DD"
+  bool      valid   = false;        // false: NTP未同期（hms は起動からの経過）
+  time_t    last    = 0;
+  struct tm tmNow   = {};
+
+  // 計測用カウンタ
+  uint32_t  secOnly = 0, full = 0, dateUpdates = 0;
+
+  void setTime(time_t t) {
+    if (valid && t == last + 1 && tmNow.tm_sec < 59) { // 大半はここ
+      tmNow.tm_sec++;
+      put2(hms + 6, tmNow.tm_sec);
+      last = t;
+      secOnly++;
+      return;
+    }
+    struct tm n;
+    localtime_r(&t, &n);
+    if (!valid || n.tm_yday != tmNow.tm_yday || n.tm_year != tmNow.tm_year) {
+      strftime(ymd, sizeof(ymd), "%Y/%m/%d", &n);
+      dateUpdates++;
+    }
+    put2(hms + 0, n.tm_hour); hms[2] = ':';
+    put2(hms + 3, n.tm_min);  hms[5] = ':';
+    put2(hms + 6, n.tm_sec);
+    tmNow = n;
+    last  = t;
+    valid = true;
+    full++;
+  }
+
+  // NTP未同期時：起動からの経過秒を表示
+  void setUptime(uint32_t s) {
+    valid = false;
+    put2(hms + 0, (int)((s / 3600) % 100)); hms[2] = ':';
+    put2(hms + 3, (int)((s / 60) % 60));    hms[5] = ':';
+    put2(hms + 6, (int)(s % 60));
+  }
+
+ private:
+  static void put2(char* d, int v) { d[0] = (char)('0' + v / 10); d[1] = (char)('0' + v % 10); }
+};
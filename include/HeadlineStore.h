@@ -0,0 +1,191 @@
+#pragma once
+// ===================== 見出しプール（固定長・重複排除） =====================
+// 見出し本文は1本の固定長プールに詰めて保持し、各フィードは (offset, length) のハンドル列だけを持つ。
+// 同じ見出しはフィード間でも取得の前後でも1回しか格納しない。区切り文字列や NUL も持たない。
+//   1見出しあたり: 本文バイト + Entry 8B + KwTags 6B + ハンドル 1B（取得中の差し替え用にもう 1B）
+//   全体で約9.2KB。エントリは 表示中 3フィード×24件 + 取得中 1フィード分（取得は1本ずつ）、
+//   プールは平均 80B × 96件ぶん（BBC の見出しは平均 75字前後、120字を超えるものはほぼない）。
+//   溢れた見出しは add() が false を返し、そのフィードは件数が減るだけ
+// 取得中は旧リストを表示に使い続け、commitFeed() で一括で差し替える。
+// 注目キーワードの照合結果（KwTags）もエントリごとに持つ。
+// Arduino 非依存。ロックは呼び出し側（gMutex）で取る。
+#include <stdint.h>
+#include <stddef.h>
+#include <string.h>
+#include "KeywordMatcher.h"
+
+static const int      HL_FEEDS        = 3;    // WORLD / BUSINESS / TECH
+static const int      HL_MAX_PER_FEED = 24;
+static const int      HL_MAX_ENTRIES  = HL_FEEDS * HL_MAX_PER_FEED + HL_MAX_PER_FEED;
+static const uint16_t HL_POOL_BYTES   = HL_MAX_ENTRIES * 80;
+static const uint8_t  HL_TEXT_MAX     = 120;  // 1見出しの最大長（BBC の見出しはほぼこれ以下）
+
+class HeadlineStore {
+ public:
+  struct Entry {
+    uint16_t off;   // プール内オフセット
+    uint8_t  len;
+    uint8_t  refs;  // bit f: 確定リスト f が参照 / bit 4+f: 取得中リスト f が参照（0 = 空き）
+    uint32_t hash;  // FNV-1a（重複検索用）
+  };
+
+  HeadlineStore() { clear(); }
+
+  void clear() {
+    memset(ent_, 0, sizeof(ent_));
+    memset(tag_, 0, sizeof(tag_));
+    memset(curCount_, 0, sizeof(curCount_));
+    memset(pendCount_, 0, sizeof(pendCount_));
+    memset(rev_, 0, sizeof(rev_));
+    tail_ = 0;
+  }
+
+  // ---- 更新（取得側） ----
+  void beginFeed(int f) {
+    abortFeed(f);
+  }
+
+  // 取得中リストに1件追加。重複は既存エントリを共有する（照合結果も既存のものを使う）。満杯なら false
+  bool add(int f, const char* s, size_t len, const KwTags* tags = nullptr) {
+    if (len == 0) return true;
+    if (len > HL_TEXT_MAX) len = HL_TEXT_MAX;
+    if (pendCount_[f] >= HL_MAX_PER_FEED) return false;
+
+    const uint8_t pbit = (uint8_t)(0x10 << f);
+    uint32_t h = fnv1a(s, len);
+    int e = find(s, len, h);
+    if (e >= 0) {
+      if (ent_[e].refs & pbit) return true; // 同じフィード内の重複
+    } else {
+      e = alloc(s, len, h);
+      if (e < 0) return false;
+      if (tags) tag_[e] = *tags;
+      else      tag_[e].clear();
+    }
+    ent_[e].refs |= pbit;
+    pend_[f][pendCount_[f]++] = (uint8_t)e;
+    return true;
+  }
+
+  // 取得中リストを確定リストに差し替える（参照が消えたエントリは空きになる）
+  void commitFeed(int f) {
+    const uint8_t cbit = (uint8_t)(1 << f), pbit = (uint8_t)(0x10 << f);
+    for (int i = 0; i < HL_MAX_ENTRIES; i++) {
+      uint8_t r = ent_[i].refs & (uint8_t)~cbit;
+      if (r & pbit) r = (uint8_t)((r & ~pbit) | cbit);
+      ent_[i].refs = r;
+    }
+    memcpy(cur_[f], pend_[f], pendCount_[f]);
+    curCount_[f]  = pendCount_[f];
+    pendCount_[f] = 0;
+    rev_[f]++;
+  }
+
+  void abortFeed(int f) {
+    const uint8_t pbit = (uint8_t)(0x10 << f);
+    for (int i = 0; i < pendCount_[f]; i++) ent_[pend_[f][i]].refs &= (uint8_t)~pbit;
+    pendCount_[f] = 0;
+  }
+
+  // ---- 参照（表示側） ----
+  int      count(int f) const { return curCount_[f]; }
+  uint32_t rev(int f)   const { return rev_[f]; }
+
+  // ロック中のみ有効なポインタ（NUL終端なし）
+  const char* text(int f, int i, uint8_t& len) const {
+    const Entry& e = ent_[cur_[f][i]];
+    len = e.len;
+    return pool_ + e.off;
+  }
+
+  const KwTags& tags(int f, int i) const { return tag_[cur_[f][i]]; }
+
+  // NUL終端でコピー。戻り値 = コピーした長さ
+  size_t copy(int f, int i, char* out, size_t outsz) const {
+    if (outsz == 0) return 0;
+    if (i < 0 || i >= curCount_[f]) { out[0] = '\0'; return 0; }
+    uint8_t len;
+    const char* p = text(f, i, len);
+    size_t n = (len < outsz - 1) ? len : outsz - 1;
+    memcpy(out, p, n);
+    out[n] = '\0';
+    return n;
+  }
+
+  // ---- 統計 ----
+  int liveEntries() const {
+    int n = 0;
+    for (int i = 0; i < HL_MAX_ENTRIES; i++) if (ent_[i].refs) n++;
+    return n;
+  }
+  uint32_t liveBytes() const {
+    uint32_t n = 0;
+    for (int i = 0; i < HL_MAX_ENTRIES; i++) if (ent_[i].refs) n += ent_[i].len;
+    return n;
+  }
+  int taggedEntries() const {
+    int n = 0;
+    for (int i = 0; i < HL_MAX_ENTRIES; i++) if (ent_[i].refs && tag_[i].any()) n++;
+    return n;
+  }
+
+ private:
+  static uint32_t fnv1a(const char* s, size_t n) {
+    uint32_t h = 2166136261u;
+    for (size_t i = 0; i < n; i++) { h ^= (uint8_t)s[i]; h *= 16777619u; }
+    return h;
+  }
+
+  int find(const char* s, size_t len, uint32_t h) const {
+    for (int i = 0; i < HL_MAX_ENTRIES; i++) {
+      const Entry& e = ent_[i];
+      if (e.refs && e.hash == h && e.len == len && memcmp(pool_ + e.off, s, len) == 0) return i;
+    }
+    return -1;
+  }
+
+  int alloc(const char* s, size_t len, uint32_t h) {
+    int slot = -1;
+    for (int i = 0; i < HL_MAX_ENTRIES; i++) if (!ent_[i].refs) { slot = i; break; }
+    if (slot < 0) return -1;
+    if (tail_ + len > HL_POOL_BYTES) compact();
+    if (tail_ + len > HL_POOL_BYTES) return -1;
+    memcpy(pool_ + tail_, s, len);
+    ent_[slot].off  = tail_;
+    ent_[slot].len  = (uint8_t)len;
+    ent_[slot].hash = h;
+    ent_[slot].refs = 0; // 呼び出し側で立てる
+    tail_ = (uint16_t)(tail_ + len);
+    return slot;
+  }
+
+  // 生きているエントリをオフセット順に前詰め（プール末尾に達した時だけ）
+  void compact() {
+    uint8_t order[HL_MAX_ENTRIES];
+    int n = 0;
+    for (int i = 0; i < HL_MAX_ENTRIES; i++) {
+      if (!ent_[i].refs) continue;
+      int j = n++;
+      while (j > 0 && ent_[order[j - 1]].off > ent_[i].off) { order[j] = order[j - 1]; j--; }
+      order[j] = (uint8_t)i;
+    }
+    uint16_t t = 0;
+    for (int k = 0; k < n; k++) {
+      Entry& e = ent_[order[k]];
+      if (e.off != t) memmove(pool_ + t, pool_ + e.off, e.len);
+      e.off = t;
+      t = (uint16_t)(t + e.len);
+    }
+    tail_ = t;
+  }
+
+  char     pool_[HL_POOL_BYTES];
+  uint16_t tail_ = 0;
+  Entry    ent_[HL_MAX_ENTRIES];
+  KwTags   tag_[HL_MAX_ENTRIES];
+  uint8_t  cur_[HL_FEEDS][HL_MAX_PER_FEED];
+  uint8_t  pend_[HL_FEEDS][HL_MAX_PER_FEED];
+  uint8_t  curCount_[HL_FEEDS];
+  uint8_t  pendCount_[HL_FEEDS];
+  uint32_t rev_[HL_FEEDS];
+};
@@ -0,0 +1,258 @@
+#pragma once
+// ===================== 注目キーワード照合（Aho-Corasick） =====================
+// キーワード一覧から起動時に1回だけ DFA を作り、以後は1バイトにつき表引き1回で全キーワードを同時に照合する。
+// キーワード数が増えても1バイトあたりのコストは変わらない（ヒット時の出力リンク辿りだけ増える）。
+//   - 大文字小文字は区別しない
+//   - 文字種を縮約：0 = 区切り（キーワードに使われていない記号・空白・非ASCII）,
+//     1 = キーワードに出てこない英数字, 2.. = キーワードに出てくる文字ごとに1クラス
+//   - キーワード中の ' ' は「区切り」にマッチする。" ai " のように書けば単語単位で照合できる
+//     （見出しの前後は beginText()/endText() で区切りとして扱う）
+//   - キーワードに記号（'&' 等）を含めると、その記号は区切り扱いではなくなる
+//   - RSS の生バイトは KwTextFilter を通して、表示と同じ文字列（タグ除去・実体参照の展開後）で照合する
+// 表の大きさ = 状態数 × クラス数 × 2B。Arduino 非依存。
+#include <stdint.h>
+#include <stddef.h>
+#include <stdlib.h>
+#include <string.h>
+#include <ctype.h>
+
+static const uint16_t KW_NONE     = 0xFFFF;
+static const int      KW_TAGS_MAX = 2; // 見出しごとに保持するキーワード番号の数
+
+// 見出し1件の照合結果
+struct KwTags {
+  uint16_t id[KW_TAGS_MAX];
+  uint8_t  n;    // 異なるキーワード数（最大 KW_TAGS_MAX）
+  uint8_t  hits; // 総ヒット数（255で飽和）
+
+  void clear() { n = 0; hits = 0; id[0] = id[1] = KW_NONE; }
+  void add(uint16_t k) {
+    if (hits < 255) hits++;
+    for (int i = 0; i < n; i++) if (id[i] == k) return;
+    if (n < KW_TAGS_MAX) id[n++] = k;
+  }
+  bool any() const { return n > 0; }
+};
+
+class KeywordMatcher {
+ public:
+  ~KeywordMatcher() { release(); }
+
+  // kws[0..n) からDFAを構築。空文字列は無視。失敗（メモリ不足 / 多すぎ）なら false
+  bool build(const char* const* kws, int n) {
+    release();
+    if (n <= 0 || n >= KW_NONE) return false;
+
+    // 文字クラス
+    for (int c = 0; c < 256; c++) cls_[c] = isalnum(c) ? 1 : 0;
+    classes_ = 2;
+    size_t maxStates = 1;
+    for (int k = 0; k < n; k++) {
+      for (const char* p = kws[k]; *p; p++) {
+        uint8_t c = (uint8_t)tolower((uint8_t)*p);
+        if (c != ' ' && cls_[c] < 2) {
+          if (classes_ == 255) return false;
+          cls_[c] = cls_[(uint8_t)toupper(c)] = (uint8_t)classes_++;
+        }
+        maxStates++;
+      }
+    }
+    if (maxStates >= KW_NONE) return false;
+
+    // トライ（未定義遷移 = KW_NONE）
+    next_ = (uint16_t*)malloc(maxStates * classes_ * sizeof(uint16_t));
+    out_  = (uint16_t*)malloc(maxStates * sizeof(uint16_t));
+    link_ = (uint16_t*)malloc(maxStates * sizeof(uint16_t));
+    uint16_t* fail  = (uint16_t*)malloc(maxStates * sizeof(uint16_t));
+    uint16_t* queue = (uint16_t*)malloc(maxStates * sizeof(uint16_t));
+    if (!next_ || !out_ || !link_ || !fail || !queue) {
+      free(fail); free(queue); release();
+      return false;
+    }
+    memset(next_, 0xFF, maxStates * classes_ * sizeof(uint16_t));
+    states_ = 1;
+    out_[0] = KW_NONE; link_[0] = 0;
+
+    for (int k = 0; k < n; k++) {
+      if (!kws[k][0]) continue;
+      uint16_t s = 0;
+      for (const char* p = kws[k]; *p; p++) {
+        uint16_t& t = next_[s * classes_ + cls_[(uint8_t)*p]];
+        if (t == KW_NONE) {
+          t = (uint16_t)states_;
+          out_[states_] = KW_NONE; link_[states_] = 0;
+          states_++;
+        }
+        s = t;
+      }
+      if (out_[s] == KW_NONE) out_[s] = (uint16_t)k; // 重複キーワードは先のものを採用
+    }
+    keywords_ = n;
+
+    // 幅優先で失敗遷移を畳み込み、完全なDFAにする。link_ = 失敗側で最も近い出力状態（0 = なし）
+    size_t qh = 0, qt = 0;
+    for (int c = 0; c < classes_; c++) {
+      uint16_t& t = next_[c];
+      if (t == KW_NONE) { t = 0; continue; }
+      fail[t] = 0; queue[qt++] = t;
+    }
+    while (qh < qt) {
+      uint16_t s = queue[qh++];
+      for (int c = 0; c < classes_; c++) {
+        uint16_t& t = next_[s * classes_ + c];
+        uint16_t  f = next_[fail[s] * classes_ + c];
+        if (t == KW_NONE) { t = f; continue; }
+        fail[t]  = f;
+        link_[t] = (out_[f] != KW_NONE) ? f : link_[f];
+        queue[qt++] = t;
+      }
+    }
+    free(fail); free(queue);
+
+    // 実際の状態数まで縮める（行は状態順に並んでいるので先頭を残すだけ）
+    void* p;
+    if ((p = realloc(next_, (size_t)states_ * classes_ * sizeof(uint16_t)))) next_ = (uint16_t*)p;
+    if ((p = realloc(out_,  (size_t)states_ * sizeof(uint16_t))))            out_  = (uint16_t*)p;
+    if ((p = realloc(link_, (size_t)states_ * sizeof(uint16_t))))            link_ = (uint16_t*)p;
+    st_ = 0;
+    return true;
+  }
+
+  void release() {
+    free(next_); free(out_); free(link_);
+    next_ = out_ = link_ = nullptr;
+    states_ = 0; keywords_ = 0; st_ = 0;
+  }
+
+  bool ready() const { return next_ != nullptr; }
+
+  // ---- 照合（1見出し = beginText → feed* → endText） ----
+  void beginText(KwTags& t) {
+    t.clear();
+    st_ = 0;
+    if (next_) step(0, t);
+  }
+  void feed(char c, KwTags& t) {
+    if (next_) step(cls_[(uint8_t)c], t);
+  }
+  void feed(const char* s, size_t len, KwTags& t) {
+    if (!next_) return;
+    for (size_t i = 0; i < len; i++) step(cls_[(uint8_t)s[i]], t);
+  }
+  void endText(KwTags& t) {
+    if (next_) step(0, t);
+  }
+
+  // ---- 統計 ----
+  int      keywords()   const { return keywords_; }
+  int      states()     const { return states_; }
+  int      classes()    const { return classes_; }
+  uint32_t tableBytes() const {
+    return next_ ? (uint32_t)states_ * ((uint32_t)classes_ + 2) * sizeof(uint16_t) + sizeof(cls_) : 0;
+  }
+
+ private:
+  void step(uint8_t c, KwTags& t) {
+    st_ = next_[st_ * classes_ + c];
+    for (uint16_t s = (out_[st_] != KW_NONE) ? st_ : link_[st_]; s; s = link_[s]) t.add(out_[s]);
+  }
+
+  uint8_t   cls_[256];
+  int       classes_  = 0;
+  int       states_   = 0;
+  int       keywords_ = 0;
+  uint16_t* next_     = nullptr; // [state][class]
+  uint16_t* out_      = nullptr; // その状態で終わるキーワード番号
+  uint16_t* link_     = nullptr; // 出力リンク
+  uint16_t  st_       = 0;
+};
+
+// ===================== RSS 本文 → 表示文字列（照合の前段） =====================
+// main.cpp は見出しを stripHtmlTags → decodeEntities → stripHtmlTags の順に整形して表示する。
+// 生の XML バイトのまま照合すると "S&amp;P" の '&' が届かず、"&#39;" の数字が混ざって表示と食い違うので、
+// 同じ変換を1バイトずつ行ってから照合器へ渡す（持つのは保留中の '<' と実体参照1個分だけ）。
+//   - タグ：'<' の次が英字 / '/' / '!' なら '>' まで捨てる。それ以外の '<' は文字として残す
+//   - 実体参照：&amp; &lt; &gt; &quot; &apos; &#39; だけ展開（decodeEntities と同じ）。
+//     &amp; は最初に一括置換されるので、展開した '&' は後続の "lt;" 等とだけ組み合わさる
+// 非ASCII はここでは寄せず、照合器が区切りとして扱う（sanitizeUtf8ToAscii が寄せる先も ' " - . ? の記号）。
+class KwTextFilter {
+ public:
+  void begin() { tag1_ = tag2_ = 0; entLen_ = 0; fromAmp_ = false; }
+
+  void feed(char c, KeywordMatcher& m, KwTags& t) { strip1(c, m, t); }
+  void feed(const char* s, size_t len, KeywordMatcher& m, KwTags& t) {
+    for (size_t i = 0; i < len; i++) strip1(s[i], m, t);
+  }
+  // 保留中の文字を吐き出す（見出しの終わり）
+  void end(KeywordMatcher& m, KwTags& t) {
+    if (tag1_ == 1) { tag1_ = 0; entity('<', m, t); }
+    flushEntity(m, t);
+    if (tag2_ == 1) { tag2_ = 0; m.feed('<', t); }
+  }
+
+ private:
+  static bool tagStart(char c) { return isalpha((unsigned char)c) || c == '/' || c == '!'; }
+
+  // タグ除去の1段（0 = 本文, 1 = '<' を保留中, 2 = タグ内）。戻り値 = c を次段へ渡す
+  static bool strip(uint8_t& st, char c, bool& pending) {
+    pending = false;
+    if (st == 2) { if (c == '>') st = 0; return false; }
+    if (st == 1) {
+      if (tagStart(c)) { st = 2; return false; }
+      st = 0; pending = true; // 保留していた '<' は文字だった
+    }
+    if (c == '<') { st = 1; return false; }
+    return true;
+  }
+
+  void strip1(char c, KeywordMatcher& m, KwTags& t) {
+    bool lt;
+    bool pass = strip(tag1_, c, lt);
+    if (lt)   entity('<', m, t);
+    if (pass) entity(c, m, t);
+  }
+
+  void strip2(char c, KeywordMatcher& m, KwTags& t) {
+    bool lt;
+    bool pass = strip(tag2_, c, lt);
+    if (lt)   m.feed('<', t);
+    if (pass) m.feed(c, t);
+  }
+
+  void entity(char c, KeywordMatcher& m, KwTags& t) {
+    if (entLen_ == 0) {
+      if (c == '&') { ent_[entLen_++] = c; fromAmp_ = false; }
+      else          strip2(c, m, t);
+      return;
+    }
+    ent_[entLen_++] = c;
+    static const char* const NAMES[] = {"&amp;", "&lt;", "&gt;", "&quot;", "&apos;", "&#39;"};
+    static const char        CHARS[] = {'&', '<', '>', '"', '\'', '\''};
+    bool prefix = false;
+    for (int i = 0; i < 6; i++) {
+      if (i == 0 && fromAmp_) continue;
+      if (strncmp(NAMES[i], ent_, entLen_) != 0) continue;
+      if (NAMES[i][entLen_] != '\0') { prefix = true; continue; }
+      entLen_ = 0;
+      if (i == 0) { ent_[entLen_++] = '&'; fromAmp_ = true; } // 後続の "lt;" 等と組み合わさりうる
+      else        strip2(CHARS[i], m, t);
+      return;
+    }
+    if (prefix) return;
+    // 実体参照ではなかった：保留分を文字として流し、最後の1文字は改めて判定
+    entLen_--;
+    flushEntity(m, t);
+    entity(c, m, t);
+  }
+
+  void flushEntity(KeywordMatcher& m, KwTags& t) {
+    for (int i = 0; i < entLen_; i++) strip2(ent_[i], m, t);
+    entLen_ = 0;
+  }
+
+  char    ent_[8];
+  uint8_t entLen_  = 0;
+  bool    fromAmp_ = false; // ent_ の '&' は &amp; を展開したもの（&amp; とは組み合わさらない）
+  uint8_t tag1_    = 0;     // 生バイト側のタグ除去
+  uint8_t tag2_    = 0;     // 展開後のタグ除去
+};
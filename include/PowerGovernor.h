@@ -0,0 +1,151 @@
+#pragma once
+// ===================== 省電力ガバナー =====================
+// 夜間帯は NIGHT（スクロール停止・最小輝度・モデムスリープ）。ボタンを押すと wakeHoldMs の間だけ ACTIVE に戻る。
+// 入力はボタンだけで「見ている」ことは分からないので、無操作での IDLE（フレームレート低下・減光）は
+// idleAfterMs を設定した時だけ使う（既定はオフ）。
+// 時刻（ms）と現地の時（0-23, 不明なら -1）は呼び出し側が渡すので、ホストで偽の時計を使って検証できる。
+// モードごとの滞在時間・起床回数・稼働時間を集計し、簡単な電力モデルで消費量を見積もる。
+// Arduino 非依存。ロックは呼び出し側で取る（他タスクの起床回数は noteWakes でまとめて渡す）。
+#include <stdint.h>
+
+enum PowerMode : uint8_t { PWR_ACTIVE = 0, PWR_IDLE, PWR_NIGHT, PWR_MODE_COUNT };
+
+// モードごとの動作設定
+struct PowerProfile {
+  uint16_t frameMs;    // ニュース/ティッカーの1コマ間隔（0 = スクロール停止）
+  uint16_t sensorMs;   // センサーページの再描画間隔
+  uint16_t pollMs;     // UiTask の最大スリープ（= ボタン応答の最悪値。短い押下を取りこぼさないよう 30 以下）
+  uint16_t netLoopMs;  // NetTask / HttpTask の待ち時間
+  uint8_t  brightness;
+  bool     modemSleep; // 取得と取得の間は Wi-Fi モデムスリープ
+};
+
+static const PowerProfile POWER_PROFILES[PWR_MODE_COUNT] = {
+  //  frame sensor poll  net  bright sleep
+  {     33,   500,   20,  20,  255,  false }, // ACTIVE: 30fps
+  {    100,  2000,   30, 100,   80,  true  }, // IDLE:   10fps
+  {      0,  5000,   30, 200,   12,  true  }, // NIGHT:  停止（時計のみ毎秒）
+};
+
+struct PowerConfig {
+  uint32_t idleAfterMs = 0;         // 無操作でIDLEへ（0 = 使わない）
+  uint32_t wakeHoldMs  = 60 * 1000; // 押下（と起動）のあと、夜間でも ACTIVE を保つ時間
+  int      nightStart  = 23;        // NIGHT の時間帯 [start, end)（日またぎ可）
+  int      nightEnd    = 6;
+};
+
+// 消費電力の概算モデル（mW, 3.3V 系）。係数はどの機種の実測でもない仮の値（ESP32 + SPI液晶 + Wi-Fi のおおよその桁）。
+// モード間の比較用で、絶対値は当てにしない。実機で測ったら model の各値を上書きする
+struct PowerModel {
+  float baseMw      = 95.0f;  // CPU 待機（240MHz, FreeRTOS tick 込み）
+  float busyMw      = 130.0f; // CPU 稼働中の上乗せ（稼働率に比例）
+  float wakeUj      = 40.0f;  // 起床1回の固定コスト
+  float wifiMw      = 330.0f; // Wi-Fi 受信待ち（スリープなし）
+  float wifiSleepMw = 60.0f;  // モデムスリープ時の平均
+  float backlightMw = 260.0f; // 輝度255 時（輝度に比例）
+
+  float estimateMw(const PowerProfile& p, float wakesPerSec, float busyFrac) const {
+    return baseMw + busyMw * busyFrac + wakeUj * wakesPerSec / 1000.0f +
+           (p.modemSleep ? wifiSleepMw : wifiMw) + backlightMw * p.brightness / 255.0f;
+  }
+};
+
+// モード別の集計
+struct PowerStats {
+  uint64_t ms     = 0; // 滞在時間
+  uint32_t wakes  = 0; // 起床回数（全タスク合計）
+  uint64_t busyUs = 0; // UiTask の稼働時間
+};
+
+class PowerGovernor {
+ public:
+  PowerConfig cfg;
+  PowerModel  model;
+
+  void begin(uint32_t nowMs) {
+    mode_ = PWR_ACTIVE;
+    lastInput_ = lastTick_ = nowMs;
+    transitions_ = 0;
+    for (int m = 0; m < PWR_MODE_COUNT; m++) stats_[m] = PowerStats();
+  }
+
+  // ボタン入力。戻り値 true = 省電力中だったので、この押下は復帰だけに使う（本来の操作はしない）
+  // 押下は M5.update() が拾う = UiTask の起床時だけなので、pollMs より短いタップは届かないことがある
+  bool onInput(uint32_t nowMs) {
+    lastInput_ = nowMs;
+    bool wasSaving = (mode_ != PWR_ACTIVE);
+    setMode(PWR_ACTIVE, nowMs);
+    return wasSaving;
+  }
+
+  // 周期評価。戻り値 = モードが変わったか
+  bool update(uint32_t nowMs, int hour) {
+    // millis() が一周（49.7日）しても「最近押された」に戻らないよう、経過は頭打ちにしておく
+    if (nowMs - lastInput_ > INPUT_AGE_CAP_MS) lastInput_ = nowMs - INPUT_AGE_CAP_MS;
+    const uint32_t since = nowMs - lastInput_;
+    PowerMode m = PWR_ACTIVE;
+    if (since >= cfg.wakeHoldMs && isNight(hour))         m = PWR_NIGHT;
+    else if (cfg.idleAfterMs && since >= cfg.idleAfterMs) m = PWR_IDLE;
+    return setMode(m, nowMs);
+  }
+
+  // 起床回数と UiTask の稼働時間を現在のモードに計上
+  void noteWakes(uint32_t n, uint32_t busyUs) {
+    stats_[mode_].wakes  += n;
+    stats_[mode_].busyUs += busyUs;
+  }
+
+  bool isNight(int hour) const {
+    if (hour < 0) return false; // 時刻不明なら夜間扱いしない
+    if (cfg.nightStart <= cfg.nightEnd) return hour >= cfg.nightStart && hour < cfg.nightEnd;
+    return hour >= cfg.nightStart || hour < cfg.nightEnd;
+  }
+
+  PowerMode           mode()        const { return mode_; }
+  const PowerProfile& profile()     const { return POWER_PROFILES[mode_]; }
+  uint32_t            transitions() const { return transitions_; }
+
+  // 集計（呼び出し時点までの滞在時間を含める）
+  PowerStats stats(int m, uint32_t nowMs) const {
+    PowerStats s = stats_[m];
+    if (m == mode_) s.ms += nowMs - lastTick_;
+    return s;
+  }
+  float wakesPerSec(int m, uint32_t nowMs) const {
+    PowerStats s = stats(m, nowMs);
+    return s.ms ? s.wakes * 1000.0f / s.ms : 0.0f;
+  }
+  float busyFrac(int m, uint32_t nowMs) const {
+    PowerStats s = stats(m, nowMs);
+    return s.ms ? (float)s.busyUs / (s.ms * 1000.0f) : 0.0f;
+  }
+  // 推定消費（mWh / 時間 = 平均 mW）。滞在実績のないモードは起床回数を設定値から見積もる
+  float estimateMwhPerHour(int m, uint32_t nowMs) const {
+    const PowerProfile& p = POWER_PROFILES[m];
+    PowerStats s = stats(m, nowMs);
+    if (s.ms == 0) {
+      float w = 1000.0f / p.pollMs;
+      if (p.frameMs && p.frameMs < p.pollMs) w = 1000.0f / p.frameMs;
+      return model.estimateMw(p, w, 0.0f);
+    }
+    return model.estimateMw(p, wakesPerSec(m, nowMs), busyFrac(m, nowMs));
+  }
+
+ private:
+  static const uint32_t INPUT_AGE_CAP_MS = 0x40000000u; // 約12日
+
+  bool setMode(PowerMode m, uint32_t nowMs) {
+    stats_[mode_].ms += nowMs - lastTick_;
+    lastTick_ = nowMs;
+    if (m == mode_) return false;
+    mode_ = m;
+    transitions_++;
+    return true;
+  }
+
+  PowerMode  mode_        = PWR_ACTIVE;
+  uint32_t   lastInput_   = 0;
+  uint32_t   lastTick_    = 0;
+  uint32_t   transitions_ = 0;
+  PowerStats stats_[PWR_MODE_COUNT];
+};
@@ -0,0 +1,406 @@
+#pragma once
+// ===================== LANリレー：バイナリプロトコル =====================
+// 1台（SERVER）が取得した状態を UDP マルチキャストで配り、他（CLIENT）はそれを購読する。
+// 1パケット = ヘッダ(10B) + 本体。数値はリトルエンディアン。
+// ヘッダの epoch は SERVER の起動ごとに変わる乱数。rev は起動のたびに 0 から数え直すので、
+// CLIENT は epoch が変わったら適用済み rev を捨てて全量を取り直す。
+// 送信側の状態（RelayServer）と受信側の状態（RelayClient）もここに置き、
+// 共有状態の読み書き・送信・ロックは呼び出し側の Host に任せる（main.cpp とホストテストで同じ実装を使う）。
+// Arduino 非依存（ホストの UDP ソケットでもそのまま使える）。
+#include <stdint.h>
+#include <stddef.h>
+#include <string.h>
+
+enum RelayRole : uint8_t { RELAY_OFF = 0, RELAY_SERVER, RELAY_CLIENT };
+
+static const uint8_t  RELAY_MAGIC0     = 'O';
+static const uint8_t  RELAY_MAGIC1     = 'K';
+static const uint8_t  RELAY_VERSION    = 3;
+static const size_t   RELAY_MAX_PACKET = 1400; // Ethernet MTU 内に収める
+static const size_t   RELAY_HDR_SZ     = 10; // magic(2) + version + type + seq(2) + epoch(4)
+
+enum RelayType : uint8_t {
+  RELAY_T_HEARTBEAT = 1, // 各項目の最新 rev（古い分割 NEWS の破棄・遅れ検出・生存確認）
+  RELAY_T_BTC       = 2, // rev, 価格
+  RELAY_T_RATES     = 3, // rev, ティッカー文字列
+  RELAY_T_NEWS      = 4, // feed, rev, 分割番号, { 長さ(1B) + 見出し }*
+};
+
+static const int RELAY_FEEDS = 3; // WORLD / BUSINESS / TECH
+
+// 送受信の間隔（SERVER と CLIENT で揃っている必要がある）
+static const uint32_t RELAY_HEARTBEAT_MS = 2  * 1000;
+static const uint32_t RELAY_KEYFRAME_MS  = 30 * 1000; // 取りこぼし救済の全量再送
+static const uint32_t RELAY_SILENCE_MS   = 20 * 1000; // これ以上無音なら直接取得へ
+// ハートビートの rev に追いつけないまま全量再送2回分を過ぎたら、届いていても直接取得へ
+static const uint32_t RELAY_BEHIND_MS    = RELAY_KEYFRAME_MS + 2 * RELAY_HEARTBEAT_MS;
+static const size_t   RELAY_TEXT_MAX     = 512; // RATES 文字列の上限（NUL 含む）
+
+// デコード結果（text は受信バッファ内を指す。NUL終端ではない）
+struct RelayMsg {
+  uint8_t     type    = 0;
+  uint16_t    seq     = 0;
+  uint32_t    epoch   = 0;       // SERVER の起動ごとの識別子
+  uint32_t    rev     = 0;
+  uint32_t    ageMs   = 0;   // SERVER 側で取得完了から送信までの経過
+  uint8_t     feed    = 0;
+  double      price   = 0.0;
+  const char* text    = nullptr; // RATES: 文字列 / NEWS: 見出しレコード列
+  uint16_t    textLen = 0;
+  uint8_t     part    = 0;       // NEWS: 分割番号 / 分割数
+  uint8_t     parts   = 0;
+  // HEARTBEAT
+  uint32_t    btcRev   = 0;
+  uint32_t    ratesRev = 0;
+  uint32_t    newsRev[RELAY_FEEDS] = {0, 0, 0};
+  uint32_t    uptimeMs = 0;
+};
+
+// ===================== 書き込み / 読み出し =====================
+struct RelayWriter {
+  uint8_t* p;
+  size_t   cap;
+  size_t   len = 0;
+  bool     ok  = true;
+
+  RelayWriter(uint8_t* buf, size_t n) : p(buf), cap(n) {}
+  void bytes(const void* src, size_t n) {
+    if (!ok || len + n > cap) { ok = false; return; }
+    memcpy(p + len, src, n); len += n;
+  }
+  void u8(uint8_t v)   { bytes(&v, 1); }
+  void u16(uint16_t v) { uint8_t b[2] = {(uint8_t)v, (uint8_t)(v >> 8)}; bytes(b, 2); }
+  void u32(uint32_t v) {
+    uint8_t b[4] = {(uint8_t)v, (uint8_t)(v >> 8), (uint8_t)(v >> 16), (uint8_t)(v >> 24)};
+    bytes(b, 4);
+  }
+  void f64(double v) {
+    uint64_t x; memcpy(&x, &v, 8);
+    u32((uint32_t)x); u32((uint32_t)(x >> 32));
+  }
+  void header(RelayType t, uint16_t seq, uint32_t epoch) {
+    u8(RELAY_MAGIC0); u8(RELAY_MAGIC1); u8(RELAY_VERSION); u8(t); u16(seq); u32(epoch);
+  }
+  size_t done() const { return ok ? len : 0; }
+};
+
+struct RelayReader {
+  const uint8_t* p;
+  size_t         n;
+  size_t         pos = 0;
+  bool           ok  = true;
+
+  RelayReader(const uint8_t* buf, size_t len) : p(buf), n(len) {}
+  const uint8_t* take(size_t k) {
+    if (!ok || pos + k > n) { ok = false; return nullptr; }
+    const uint8_t* r = p + pos; pos += k; return r;
+  }
+  uint8_t  u8()  { const uint8_t* b = take(1); return b ? b[0] : 0; }
+  uint16_t u16() { const uint8_t* b = take(2); return b ? (uint16_t)(b[0] | (b[1] << 8)) : 0; }
+  uint32_t u32() {
+    const uint8_t* b = take(4);
+    return b ? ((uint32_t)b[0] | ((uint32_t)b[1] << 8) | ((uint32_t)b[2] << 16) | ((uint32_t)b[3] << 24)) : 0;
+  }
+  double f64() {
+    uint64_t lo = u32(), hi = u32();
+    uint64_t x = lo | (hi << 32);
+    double v; memcpy(&v, &x, 8); return v;
+  }
+};
+
+// ===================== エンコード =====================
+static inline size_t relayEncodeBtc(uint8_t* buf, size_t cap, uint16_t seq, uint32_t epoch,
+                                    uint32_t rev, double price, uint32_t ageMs) {
+  RelayWriter w(buf, cap);
+  w.header(RELAY_T_BTC, seq, epoch);
+  w.u32(rev); w.u32(ageMs); w.f64(price);
+  return w.done();
+}
+
+static inline size_t relayEncodeRates(uint8_t* buf, size_t cap, uint16_t seq, uint32_t epoch,
+                                      uint32_t rev, uint32_t ageMs, const char* s) {
+  size_t sl = s ? strlen(s) : 0;
+  RelayWriter w(buf, cap);
+  w.header(RELAY_T_RATES, seq, epoch);
+  w.u32(rev); w.u32(ageMs);
+  if (sl > RELAY_MAX_PACKET - 32) sl = RELAY_MAX_PACKET - 32;
+  w.u16((uint16_t)sl); w.bytes(s, sl);
+  return w.done();
+}
+
+// NEWS は見出しを1パケットに詰められるだけ詰め、溢れたら分割する
+static const size_t RELAY_NEWS_HDR_SZ = RELAY_HDR_SZ + 4 + 4 + 1 + 1 + 1;
+
+static inline void relayBeginNews(RelayWriter& w, uint16_t seq, uint32_t epoch, uint8_t feed,
+                                  uint32_t rev, uint32_t ageMs, uint8_t part, uint8_t parts) {
+  w.header(RELAY_T_NEWS, seq, epoch);
+  w.u32(rev); w.u32(ageMs);
+  w.u8(feed); w.u8(part); w.u8(parts);
+}
+
+static inline void relayAddTitle(RelayWriter& w, const char* s, uint8_t len) {
+  w.u8(len); w.bytes(s, len);
+}
+
+// 見出しレコード列を1件ずつ取り出す
+static inline bool relayNextTitle(RelayReader& r, const char*& s, uint8_t& len) {
+  if (r.pos >= r.n) return false;
+  len = r.u8();
+  s   = (const char*)r.take(len);
+  return r.ok;
+}
+
+static inline size_t relayEncodeHeartbeat(uint8_t* buf, size_t cap, uint16_t seq, uint32_t epoch,
+                                          uint32_t btcRev, uint32_t ratesRev,
+                                          const uint32_t newsRev[RELAY_FEEDS], uint32_t uptimeMs) {
+  RelayWriter w(buf, cap);
+  w.header(RELAY_T_HEARTBEAT, seq, epoch);
+  w.u32(btcRev); w.u32(ratesRev);
+  for (int i = 0; i < RELAY_FEEDS; i++) w.u32(newsRev[i]);
+  w.u32(uptimeMs);
+  return w.done();
+}
+
+// ===================== デコード =====================
+static inline bool relayDecode(const uint8_t* buf, size_t len, RelayMsg& m) {
+  RelayReader r(buf, len);
+  if (r.u8() != RELAY_MAGIC0 || r.u8() != RELAY_MAGIC1) return false;
+  if (r.u8() != RELAY_VERSION) return false;
+  m.type  = r.u8();
+  m.seq   = r.u16();
+  m.epoch = r.u32();
+
+  switch (m.type) {
+    case RELAY_T_HEARTBEAT:
+      m.btcRev = r.u32(); m.ratesRev = r.u32();
+      for (int i = 0; i < RELAY_FEEDS; i++) m.newsRev[i] = r.u32();
+      m.uptimeMs = r.u32();
+      break;
+    case RELAY_T_BTC:
+      m.rev = r.u32(); m.ageMs = r.u32(); m.price = r.f64();
+      break;
+    case RELAY_T_RATES:
+      m.rev = r.u32(); m.ageMs = r.u32();
+      m.textLen = r.u16();
+      m.text = (const char*)r.take(m.textLen);
+      break;
+    case RELAY_T_NEWS:
+      m.rev = r.u32(); m.ageMs = r.u32();
+      m.feed = r.u8(); m.part = r.u8(); m.parts = r.u8();
+      if (m.feed >= RELAY_FEEDS || m.part >= m.parts) return false;
+      m.text    = (const char*)(buf + r.pos);
+      m.textLen = (uint16_t)(len - r.pos);
+      break;
+    default:
+      return false;
+  }
+  return r.ok;
+}
+
+
+// NEWS の part 番目のパケットを作る。見出し単位で詰め、溢れたら次の分割へ（parts は総分割数を返す）。
+// News は count(f) / text(f, i, len) を持つもの（HeadlineStore）
+template <class News>
+static size_t relayPackNews(uint8_t* buf, size_t cap, const News& news, int f, uint8_t part, uint8_t& parts,
+                            uint16_t seq, uint32_t epoch, uint32_t rev, uint32_t ageMs) {
+  uint8_t p = 0;
+  size_t used = RELAY_NEWS_HDR_SZ;
+  int first = 0, last = 0; // part の担当範囲 [first, last)
+  const int n = news.count(f);
+  for (int i = 0; i < n; i++) {
+    uint8_t len;
+    news.text(f, i, len);
+    if (used + 1 + len > cap) { p++; used = RELAY_NEWS_HDR_SZ; }
+    used += 1 + len;
+    if (p < part)  first = i + 1;
+    if (p == part) last  = i + 1;
+  }
+  parts = (uint8_t)(p + 1);
+  RelayWriter w(buf, cap);
+  relayBeginNews(w, seq, epoch, (uint8_t)f, rev, ageMs, part, parts);
+  for (int i = first; i < last; i++) {
+    uint8_t len;
+    const char* t = news.text(f, i, len);
+    relayAddTitle(w, t, len);
+  }
+  return w.done();
+}
+
+// ===================== SERVER =====================
+// 取得が成功するたびに note*() で rev を進め、pump() で変化した項目だけ送る。
+// 定期的に全量を再送して取りこぼしを救済し、ハートビートで各項目の最新 rev を知らせる。
+// Host が用意するもの：
+//   void          relaySend(const uint8_t* p, size_t n);
+//   double        relayBtc();
+//   void          relayRates(char* out, size_t cap);
+//   const News&   relayNewsLock();   // 見出しを読む間だけロック（relayPackNews に渡す）
+//   void          relayNewsUnlock();
+struct RelayServer {
+  uint16_t seq     = 0;
+  uint32_t epoch   = 0;  // 起動ごとの乱数（0 以外）
+  uint32_t lastHb  = 0;  // 最終ハートビート
+  uint32_t lastKey = 0;  // 最終全量再送
+  // 取得ごとに進む rev / 送信済み rev / 取得完了時刻
+  uint32_t btcRev = 0, ratesRev = 0, newsRev[RELAY_FEEDS] = {0, 0, 0};
+  uint32_t sentBtc = 0, sentRates = 0, sentNews[RELAY_FEEDS] = {0, 0, 0};
+  uint32_t btcAt = 0, ratesAt = 0, newsAt[RELAY_FEEDS] = {0, 0, 0};
+
+  void noteBtc(uint32_t now)          { btcRev++;     btcAt = now; }
+  void noteRates(uint32_t now)        { ratesRev++;   ratesAt = now; }
+  void noteNews(int f, uint32_t now)  { newsRev[f]++; newsAt[f] = now; }
+
+  template <class Host>
+  void pump(uint32_t now, uint8_t* buf, size_t cap, Host& h) {
+    if (now - lastKey >= RELAY_KEYFRAME_MS) {
+      lastKey = now;
+      sentBtc = 0; sentRates = 0;
+      for (int i = 0; i < RELAY_FEEDS; i++) sentNews[i] = 0;
+    }
+
+    if (btcRev && sentBtc != btcRev) {
+      send(h, relayEncodeBtc(buf, cap, seq++, epoch, btcRev, h.relayBtc(), now - btcAt), buf);
+      sentBtc = btcRev;
+    }
+
+    if (ratesRev && sentRates != ratesRev) {
+      char text[RELAY_TEXT_MAX];
+      h.relayRates(text, sizeof(text));
+      send(h, relayEncodeRates(buf, cap, seq++, epoch, ratesRev, now - ratesAt, text), buf);
+      sentRates = ratesRev;
+    }
+
+    for (int f = 0; f < RELAY_FEEDS; f++) {
+      if (!newsRev[f] || sentNews[f] == newsRev[f]) continue;
+      uint8_t parts = 1;
+      for (uint8_t part = 0; part < parts; part++) {
+        size_t n = relayPackNews(buf, cap, h.relayNewsLock(), f, part, parts,
+                                 seq++, epoch, newsRev[f], now - newsAt[f]);
+        h.relayNewsUnlock();
+        send(h, n, buf);
+      }
+      sentNews[f] = newsRev[f];
+    }
+
+    if (now - lastHb >= RELAY_HEARTBEAT_MS) {
+      lastHb = now;
+      send(h, relayEncodeHeartbeat(buf, cap, seq++, epoch, btcRev, ratesRev, newsRev, now), buf);
+    }
+  }
+
+ private:
+  template <class Host>
+  static void send(Host& h, size_t n, const uint8_t* buf) {
+    if (n) h.relaySend(buf, n);
+  }
+};
+
+// ===================== CLIENT =====================
+// 届いたパケットを onPacket() に渡すと、rev が変わった項目だけ Host に適用させる。
+// NEWS は分割パケットを順に取り込み、最後の分割で差し替える（途中が欠けたら破棄して次の更新か全量再送を待つ）。
+// Host が用意するもの：
+//   void relayApplyBtc(double price);
+//   void relayApplyRates(const char* s, size_t len);
+//   void relayNewsBegin(int f);                           // 取得中リストを作り直す
+//   void relayNewsTitle(int f, const char* s, uint8_t len);
+//   void relayNewsCommit(int f);                          // 表示中リストと差し替え
+//   void relayNewsAbort(int f);                           // 取得中リストを捨てる（表示中はそのまま）
+//   void relayResynced();                                 // SERVER の再起動を検出した
+struct RelayClient {
+  uint32_t epoch       = 0; // 購読中の SERVER の epoch
+  uint32_t lastRx      = 0; // 最終受信時刻
+  uint32_t behindSince = 0; // ハートビートの rev に遅れ始めた時刻（0 = 追いついている）
+  // 適用済み rev / 分割受信中の NEWS（rev と次に期待する分割番号）
+  uint32_t btcRev = 0, ratesRev = 0, newsRev[RELAY_FEEDS] = {0, 0, 0};
+  uint32_t newsPendRev[RELAY_FEEDS] = {0, 0, 0};
+  uint8_t  newsNextPart[RELAY_FEEDS] = {0, 0, 0};
+
+  // 起動直後は猶予を与えてからフォールバック判定
+  void start(uint32_t now) { lastRx = now; }
+
+  // 戻り値 = 差分を適用した（NEWS は最後の分割で差し替えたとき）
+  template <class Host>
+  bool onPacket(const RelayMsg& m, uint32_t rxAt, Host& h) {
+    lastRx = rxAt;
+    if (m.epoch != epoch) resync(m.epoch, h);
+
+    if (m.type == RELAY_T_HEARTBEAT) {
+      checkHeartbeat(m, rxAt, h);
+    } else if (m.type == RELAY_T_BTC && m.rev != btcRev) {
+      h.relayApplyBtc(m.price);
+      btcRev = m.rev;
+      return true;
+    } else if (m.type == RELAY_T_RATES && m.rev != ratesRev) {
+      h.relayApplyRates(m.text, m.textLen);
+      ratesRev = m.rev;
+      return true;
+    } else if (m.type == RELAY_T_NEWS && m.rev != newsRev[m.feed]) {
+      return applyNewsPart(m, h);
+    }
+    return false;
+  }
+
+  // リレーが生きているか：無音が続いていない、かつ遅れが長引いていない。
+  // now は受信より前に取った時刻のことがある（lastRx / behindSince の方が新しい）ので符号付きで比べる
+  bool live(uint32_t now) const {
+    return (int32_t)(now - lastRx) < (int32_t)RELAY_SILENCE_MS &&
+           !(behindSince && (int32_t)(now - behindSince) >= (int32_t)RELAY_BEHIND_MS);
+  }
+
+ private:
+  template <class Host>
+  void abortNews(int f, Host& h) {
+    if (!newsPendRev[f]) return;
+    h.relayNewsAbort(f);
+    newsPendRev[f] = 0;
+  }
+
+  // SERVER が再起動した（epoch が変わった）。rev は 0 から数え直されるので
+  // 適用済み rev を忘れ、次に届く差分 / 全量再送をすべて取り込み直す
+  template <class Host>
+  void resync(uint32_t e, Host& h) {
+    for (int f = 0; f < RELAY_FEEDS; f++) {
+      abortNews(f, h);
+      newsRev[f] = 0;
+    }
+    btcRev = 0; ratesRev = 0;
+    behindSince = 0;
+    if (epoch) h.relayResynced();
+    epoch = e;
+  }
+
+  // ハートビートの rev と突き合わせる。受信途中の NEWS が古くなっていたら捨て、
+  // 適用済み rev が追いついていない時刻を記録する（長引いたら live() が false）
+  template <class Host>
+  void checkHeartbeat(const RelayMsg& m, uint32_t rxAt, Host& h) {
+    bool behind = (m.btcRev != btcRev) || (m.ratesRev != ratesRev);
+    for (int f = 0; f < RELAY_FEEDS; f++) {
+      if (newsPendRev[f] && newsPendRev[f] != m.newsRev[f]) abortNews(f, h);
+      if (m.newsRev[f] != newsRev[f]) behind = true;
+    }
+    if (!behind)           behindSince = 0;
+    else if (!behindSince) behindSince = rxAt | 1;
+  }
+
+  template <class Host>
+  bool applyNewsPart(const RelayMsg& m, Host& h) {
+    const int f = m.feed;
+    if (m.part == 0) {
+      newsPendRev[f]  = m.rev;
+      newsNextPart[f] = 0;
+      h.relayNewsBegin(f);
+    }
+    if (m.rev != newsPendRev[f] || m.part != newsNextPart[f]) {
+      abortNews(f, h);
+      return false;
+    }
+    RelayReader r((const uint8_t*)m.text, m.textLen);
+    const char* t;
+    uint8_t len;
+    while (relayNextTitle(r, t, len)) h.relayNewsTitle(f, t, len);
+    if (++newsNextPart[f] != m.parts) return false;
+    h.relayNewsCommit(f);
+    newsRev[f]     = m.rev;
+    newsPendRev[f] = 0;
+    return true;
+  }
+};
@@ -0,0 +1,63 @@
+#pragma once
+// ===================== ページ静的レイヤーのRLEキャッシュ =====================
+// 4bitパレット番号の画像を行ごとにランレングス圧縮して保持し、LUTで RGB565 に展開して流す。
+// 1ラン = 1バイト: 下位4bit = パレット番号, 上位4bit = 長さ-1（1..16px）。ランは行をまたがない。
+// 背景ベタ塗り中心の画面なら 320x240 で数KB（4bit生データ 38400B に対して）。
+#include <stdint.h>
+#include <stdlib.h>
+
+struct RleImage {
+  uint16_t w    = 0;
+  uint16_t h    = 0;
+  uint8_t* data = nullptr;
+  uint32_t size = 0;
+
+  bool valid() const { return data != nullptr; }
+  void release() { free(data); data = nullptr; size = 0; }
+};
+
+// out == nullptr ならサイズ計算のみ
+template <class GetPix>
+static uint32_t rleEncodeRows(uint16_t w, uint16_t h, GetPix get, uint8_t* out) {
+  uint32_t n = 0;
+  for (uint16_t y = 0; y < h; y++) {
+    uint16_t x = 0;
+    while (x < w) {
+      uint8_t  idx = (uint8_t)(get(x, y) & 0x0F);
+      uint16_t run = 1;
+      while (x + run < w && run < 16 && (uint8_t)(get(x + run, y) & 0x0F) == idx) run++;
+      if (out) out[n] = (uint8_t)(((run - 1) << 4) | idx);
+      n++;
+      x += run;
+    }
+  }
+  return n;
+}
+
+// get(x, y) → パレット番号(0..15)
+template <class GetPix>
+static bool rleEncode(RleImage& img, uint16_t w, uint16_t h, GetPix get) {
+  img.release();
+  uint32_t n = rleEncodeRows(w, h, get, nullptr);
+  uint8_t* p = (uint8_t*)malloc(n);
+  if (!p) return false;
+  rleEncodeRows(w, h, get, p);
+  img.w = w; img.h = h; img.data = p; img.size = n;
+  return true;
+}
+
+// 1行ずつ展開して sink(y, line) に渡す。line は w 要素以上
+template <class LineSink>
+static void rleDecode(const RleImage& img, const uint16_t* lut, uint16_t* line, LineSink sink) {
+  const uint8_t* p = img.data;
+  for (uint16_t y = 0; y < img.h; y++) {
+    uint16_t x = 0;
+    while (x < img.w) {
+      uint8_t  b   = *p++;
+      uint16_t c   = lut[b & 0x0F];
+      uint16_t run = (uint16_t)((b >> 4) + 1);
+      while (run--) line[x++] = c;
+    }
+    sink(y, line);
+  }
+}
@@ -0,0 +1,232 @@
+#pragma once
+// ===================== センサー統計（スライディングウィンドウ） =====================
+// 1サンプルあたり O(1)（min/max は単調デックで償却 O(1)）、メモリはウィンドウごとに固定。
+// Arduino 非依存なのでホストでもそのままビルドできる。
+#include <stdint.h>
+#include <math.h>
+
+struct WindowStats {
+  float    min  = NAN;
+  float    max  = NAN;
+  float    mean = NAN;
+  float    sd   = NAN;
+  uint32_t n    = 0;
+};
+
+// 1バケット分の集計。値は基準値 ref からの差で持つ（float でも二乗和が桁落ちしない）
+struct StatBucket {
+  float    mn, mx;
+  float    sum, sum2;
+  uint16_t n;
+  void clear() { mn = INFINITY; mx = -INFINITY; sum = 0; sum2 = 0; n = 0; }
+  void add(float d) {
+    if (d < mn) mn = d;
+    if (d > mx) mx = d;
+    sum += d; sum2 += d * d; n++;
+  }
+};
+
+// 直近 N バケット（進行中の1個を含む）を対象にした移動統計
+//   メモリ: (N-1) * sizeof(StatBucket) + 2 * (N-1) バイト + 数十バイト
+template <uint8_t N>
+class RollingWindow {
+  static_assert(N >= 2, "window needs at least 2 buckets");
+  static const uint8_t CAP = N - 1; // 確定済みバケット数
+
+ public:
+  explicit RollingWindow(uint32_t bucketMs) : bucketMs_(bucketMs) { reset(); }
+
+  void reset() {
+    started_ = false;
+    head_ = 0; filled_ = 0;
+    minQ_.clear(); maxQ_.clear();
+    totSum_ = 0; totSum2_ = 0; totN_ = 0;
+    cur_.clear();
+  }
+
+  void add(uint32_t tMs, float v) {
+    if (isnan(v)) return;
+    uint32_t seq = tMs / bucketMs_;
+    if (!started_ || (int32_t)(seq - curSeq_) < 0) { // 初回 or millis() 巻き戻り
+      reset();
+      started_ = true;
+      ref_ = v;
+      curSeq_ = seq;
+    }
+    if (seq != curSeq_) advance(seq);
+    cur_.add(v - ref_);
+  }
+
+  bool stats(WindowStats& out) const {
+    uint32_t n = totN_ + cur_.n;
+    if (n == 0) return false;
+    double sum  = totSum_  + cur_.sum;
+    double sum2 = totSum2_ + cur_.sum2;
+    double m    = sum / n;
+    double var  = sum2 / n - m * m;
+    if (var < 0) var = 0;
+
+    float mn = cur_.mn, mx = cur_.mx;
+    if (!minQ_.empty() && bucket(minQ_.front()).mn < mn) mn = bucket(minQ_.front()).mn;
+    if (!maxQ_.empty() && bucket(maxQ_.front()).mx > mx) mx = bucket(maxQ_.front()).mx;
+
+    out.min  = mn + ref_;
+    out.max  = mx + ref_;
+    out.mean = (float)m + ref_;
+    out.sd   = (float)sqrt(var);
+    out.n    = n;
+    return true;
+  }
+
+  // k=0: 進行中バケット、k>=1: k個前の確定バケットの平均（空なら NAN）
+  float bucketMeanAgo(uint8_t k) const {
+    if (k == 0) return cur_.n ? cur_.sum / cur_.n + ref_ : NAN;
+    if (k > filled_) return NAN;
+    const StatBucket& b = bucket((uint8_t)((head_ + CAP - k) % CAP));
+    return b.n ? b.sum / b.n + ref_ : NAN;
+  }
+
+  uint32_t bucketMs() const { return bucketMs_; }
+
+ private:
+  // スロット番号の固定長デック（単調デック用）
+  struct SlotDeque {
+    uint8_t q[CAP];
+    uint8_t h, c;
+    void    clear()       { h = 0; c = 0; }
+    bool    empty() const { return c == 0; }
+    uint8_t front() const { return q[h]; }
+    uint8_t back()  const { return q[(h + c - 1) % CAP]; }
+    void    popFront()    { h = (h + 1) % CAP; c--; }
+    void    popBack()     { c--; }
+    void    pushBack(uint8_t s) { q[(h + c) % CAP] = s; c++; }
+  };
+
+  const StatBucket& bucket(uint8_t slot) const { return ring_[slot]; }
+
+  // 進行中バケットを確定し、空白期間は空バケットで埋める（最大 CAP 回 → 定数）
+  void advance(uint32_t seq) {
+    uint32_t gap = seq - curSeq_;
+    push(cur_);
+    StatBucket empty; empty.clear();
+    for (uint32_t i = 1; i < gap && i <= CAP; i++) push(empty);
+    curSeq_ = seq;
+    cur_.clear();
+  }
+
+  void push(const StatBucket& b) {
+    uint8_t slot = head_;
+    if (filled_ == CAP) {
+      const StatBucket& old = ring_[slot];
+      totSum_ -= old.sum; totSum2_ -= old.sum2; totN_ -= old.n;
+      // 追い出すのは最古バケット → デック先頭と一致すれば外す
+      if (!minQ_.empty() && minQ_.front() == slot) minQ_.popFront();
+      if (!maxQ_.empty() && maxQ_.front() == slot) maxQ_.popFront();
+    } else {
+      filled_++;
+    }
+    ring_[slot] = b;
+    totSum_ += b.sum; totSum2_ += b.sum2; totN_ += b.n;
+    if (b.n) {
+      while (!minQ_.empty() && ring_[minQ_.back()].mn >= b.mn) minQ_.popBack();
+      minQ_.pushBack(slot);
+      while (!maxQ_.empty() && ring_[maxQ_.back()].mx <= b.mx) maxQ_.popBack();
+      maxQ_.pushBack(slot);
+    }
+    head_ = (uint8_t)((head_ + 1) % CAP);
+  }
+
+  uint32_t   bucketMs_;
+  bool       started_ = false;
+  uint32_t   curSeq_  = 0;
+  float      ref_     = 0;
+  StatBucket cur_;
+  StatBucket ring_[CAP];
+  uint8_t    head_ = 0, filled_ = 0;
+  SlotDeque  minQ_, maxQ_;
+  double     totSum_ = 0, totSum2_ = 0; // 加減算の誤差蓄積を抑えるため合計だけ double
+  uint32_t   totN_ = 0;
+};
+
+// ===================== 1系列ぶん（5分 / 1時間 / 24時間） =====================
+enum StatWindow : uint8_t { WIN_5M = 0, WIN_1H, WIN_24H, WIN_COUNT };
+static const char* const STAT_WINDOW_LABELS[WIN_COUNT] = {"5m", "1h", "24h"};
+
+struct SensorSeries {
+  RollingWindow<30> w5m  {10 * 1000};       // 10秒 × 30
+  RollingWindow<60> w1h  {60 * 1000};       // 1分 × 60
+  RollingWindow<96> w24h {15 * 60 * 1000};  // 15分 × 96
+
+  void add(uint32_t tMs, float v) {
+    w5m.add(tMs, v); w1h.add(tMs, v); w24h.add(tMs, v);
+  }
+  bool stats(StatWindow w, WindowStats& out) const {
+    switch (w) {
+      case WIN_5M:  return w5m.stats(out);
+      case WIN_1H:  return w1h.stats(out);
+      default:      return w24h.stats(out);
+    }
+  }
+};
+
+// ===================== 派生値 =====================
+// 露点（Magnus式, -45..60℃で誤差 ±0.35℃程度）
+static inline float dewPointC(float t, float rh) {
+  if (isnan(t) || isnan(rh) || rh <= 0) return NAN;
+  const float a = 17.62f, b = 243.12f;
+  float g = logf(rh / 100.0f) + a * t / (b + t);
+  return b * g / (a - g);
+}
+
+// 体感温度（NOAA Heat Index: Rothfusz回帰 + 補正）
+static inline float heatIndexC(float t, float rh) {
+  if (isnan(t) || isnan(rh)) return NAN;
+  float T = t * 9.0f / 5.0f + 32.0f;
+  float hi = 0.5f * (T + 61.0f + (T - 68.0f) * 1.2f + rh * 0.094f);
+  if ((hi + T) / 2.0f >= 80.0f) {
+    hi = -42.379f + 2.04901523f * T + 10.14333127f * rh
+         - 0.22475541f * T * rh - 0.00683783f * T * T
+         - 0.05481717f * rh * rh + 0.00122874f * T * T * rh
+         + 0.00085282f * T * rh * rh - 0.00000199f * T * T * rh * rh;
+    if (rh < 13.0f && T >= 80.0f && T <= 112.0f)
+      hi -= ((13.0f - rh) / 4.0f) * sqrtf((17.0f - fabsf(T - 95.0f)) / 17.0f);
+    else if (rh > 85.0f && T >= 80.0f && T <= 87.0f)
+      hi += ((rh - 85.0f) / 10.0f) * ((87.0f - T) / 5.0f);
+  }
+  return (hi - 32.0f) * 5.0f / 9.0f;
+}
+
+// 3時間気圧傾向（気象通報の閾値に準拠: 1.6 / 3.6 hPa）
+enum PressureTrend : uint8_t {
+  PT_UNKNOWN = 0, PT_FALLING_FAST, PT_FALLING, PT_STEADY, PT_RISING, PT_RISING_FAST
+};
+
+static inline PressureTrend classifyPressureTrend(float delta3h) {
+  if (isnan(delta3h))    return PT_UNKNOWN;
+  if (delta3h <= -3.6f)  return PT_FALLING_FAST;
+  if (delta3h <= -1.6f)  return PT_FALLING;
+  if (delta3h <   1.6f)  return PT_STEADY;
+  if (delta3h <   3.6f)  return PT_RISING;
+  return PT_RISING_FAST;
+}
+
+static inline const char* pressureOutlook(PressureTrend t) {
+  switch (t) {
+    case PT_FALLING_FAST: return "Stormy";
+    case PT_FALLING:      return "Rain likely";
+    case PT_STEADY:       return "No change";
+    case PT_RISING:       return "Improving";
+    case PT_RISING_FAST:  return "Fair, windy";
+    default:              return "Collecting...";
+  }
+}
+
+// 24h ウィンドウ（15分バケット）から 3時間前との差を取る
+static inline float pressureDelta3h(const SensorSeries& p) {
+  const uint8_t k = (uint8_t)((3UL * 60 * 60 * 1000) / p.w24h.bucketMs()); // = 12
+  float now  = p.w24h.bucketMeanAgo(0);
+  if (isnan(now)) now = p.w24h.bucketMeanAgo(1);
+  float past = p.w24h.bucketMeanAgo(k);
+  if (isnan(now) || isnan(past)) return NAN;
+  return now - past;
+}
@@ -0,0 +1,311 @@
+#pragma once
+// ===================== ステータス / メトリクス HTTP =====================
+// 共有状態のスナップショットを JSON / Prometheus テキストに直接シリアライズする。
+// String を組み立てず、固定長バッファ経由で Sink（WiFiClient 等）へ流し込む。
+// Sink は size_t write(const uint8_t*, size_t) を持っていれば何でもよい（ホストのソケットでも可）。
+#include <stdint.h>
+#include <stddef.h>
+#include <stdarg.h>
+#include <stdio.h>
+#include <string.h>
+#include <math.h>
+
+// 取得元（メトリクスのラベル）
+enum FetchSrc : uint8_t { SRC_BTC = 0, SRC_RSS_WORLD, SRC_RSS_BUSINESS, SRC_RSS_TECH, SRC_RATES, SRC_COUNT };
+static const char* const FETCH_SRC_NAMES[SRC_COUNT] = {
+  "btc", "rss_world", "rss_business", "rss_tech", "rates"
+};
+
+static const size_t SNAP_TICKER_SZ = 512;
+static const int    SNAP_FEEDS     = 3;
+static const char* const SNAP_FEED_NAMES[SNAP_FEEDS] = {"world", "business", "tech"};
+static const int    SNAP_POWER_MODES = 3;
+static const char* const SNAP_POWER_MODE_NAMES[SNAP_POWER_MODES] = {"active", "idle", "night"};
+
+// 見出しは量が多いのでスナップショットにコピーせず、1件ずつ取り出す（取り出し側で短時間ロック）。
+// rev はスナップショット時点のフィード rev。応答中に取得が確定して rev が変わったら false を返し、
+// 2世代の見出しが1つの応答に混ざらないようにする
+typedef bool (*HeadlineFn)(int feed, uint32_t rev, int index, char* out, size_t outsz);
+
+struct StatusSnapshot {
+  uint32_t uptimeMs = 0;
+
+  double   btc = 0, btcPrev = 0;
+  uint32_t btcRev = 0;
+  float    btcChange24h = NAN;
+  uint32_t candleCloses = 0, chartDrawUs = 0;
+  char     ticker[SNAP_TICKER_SZ] = "";
+  uint32_t newsRev[SNAP_FEEDS] = {};
+  HeadlineFn headline = nullptr;
+
+  float    temp = NAN, humid = NAN, pressure = NAN, press3h = NAN;
+
+  uint32_t heapFree = 0, heapMin = 0;
+  bool     wifiOk = false;
+  int      rssi = 0;
+
+  uint32_t fetchMs[SRC_COUNT]   = {};
+  uint32_t fetchOk[SRC_COUNT]   = {};
+  uint32_t fetchFail[SRC_COUNT] = {};
+  uint32_t upstreamReqs = 0;
+  uint32_t relayRx = 0, relayTx = 0, relayAgeMs = 0, relayResyncs = 0;
+  bool     relayLive = false;
+  uint8_t  relayRole = 0;
+
+  uint32_t clockSkewUs = 0, clockSkewMaxUs = 0, clockSkewAvgUs = 0;
+  uint32_t clockSecOnly = 0, clockFull = 0, clockDateUpd = 0;
+  uint32_t pushTopUs = 0, pushTickerUs = 0, pushNewsUs = 0;
+  uint32_t pageRestoreUs = 0, pageSwitchUs = 0, pageSwitchMaxUs = 0, pageCacheBytes = 0;
+
+  uint32_t newsCount[SNAP_FEEDS] = {};
+  uint32_t newsPoolBytes = 0, newsPoolCap = 0, newsEntries = 0, newsRotateUs = 0;
+  uint32_t newsWatched = 0, watchKeywords = 0, watchStates = 0, watchTableBytes = 0;
+
+  uint8_t  powerMode = 0, brightness = 0;
+  uint32_t powerTransitions = 0;
+  double   powerSec[SNAP_POWER_MODES]   = {}; // 滞在時間（カウンタなので float より桁を持たせる）
+  float    powerWakes[SNAP_POWER_MODES] = {}; // 起床回数/秒（全タスク）
+  float    powerMwh[SNAP_POWER_MODES]   = {}; // 推定消費 mWh/時間（仮の係数による目安）
+};
+
+// ===================== 固定長バッファ出力 =====================
+template <class Sink>
+class ChunkOut {
+ public:
+  explicit ChunkOut(Sink& s) : sink_(s) {}
+  ~ChunkOut() { flush(); }
+
+  void put(char c) {
+    if (n_ == sizeof(buf_)) flush();
+    buf_[n_++] = c;
+  }
+  void str(const char* p) { while (*p) put(*p++); }
+  void fmt(const char* f, ...) {
+    char tmp[64];
+    va_list ap; va_start(ap, f);
+    vsnprintf(tmp, sizeof(tmp), f, ap);
+    va_end(ap);
+    str(tmp);
+  }
+  // NaN は JSON では null
+  void num(double v, const char* f) {
+    if (isnan(v)) str("null");
+    else          fmt(f, v);
+  }
+  void jsonStr(const char* p) {
+    put('"');
+    for (; *p; p++) {
+      unsigned char c = (unsigned char)*p;
+      if      (c == '"')  str("\\\"");
+      else if (c == '\\') str("\\\\");
+      else if (c == '\n') str("\\n");
+      else if (c < 0x20)  fmt("\\u%04x", c);
+      else                put((char)c);
+    }
+    put('"');
+  }
+  void flush() {
+    if (n_) { sink_.write((const uint8_t*)buf_, n_); n_ = 0; }
+  }
+
+ private:
+  Sink&  sink_;
+  char   buf_[256];
+  size_t n_ = 0;
+};
+
+// ===================== リクエスト行 =====================
+// "GET /metrics HTTP/1.1" → "/metrics"（クエリは捨てる）。GET 以外は false
+static inline bool httpParseGetPath(const char* line, char* out, size_t outsz) {
+  if (strncmp(line, "GET ", 4) != 0 || outsz == 0) return false;
+  const char* p = line + 4;
+  size_t n = 0;
+  while (*p && *p != ' ' && *p != '?' && n + 1 < outsz) out[n++] = *p++;
+  out[n] = '\0';
+  return n > 0;
+}
+
+template <class Sink>
+static void httpWriteHeader(ChunkOut<Sink>& o, int code, const char* type) {
+  o.fmt("HTTP/1.1 %d %s\r\n", code, code == 200 ? "OK" : "Not Found");
+  o.str("Content-Type: "); o.str(type); o.str("\r\n");
+  o.str("Cache-Control: no-store\r\nConnection: close\r\n\r\n");
+}
+
+// ===================== JSON =====================
+template <class Sink>
+static void writeStatusJson(ChunkOut<Sink>& o, const StatusSnapshot& s) {
+  o.fmt("{\"uptime_ms\":%lu,", (unsigned long)s.uptimeMs);
+
+  o.str("\"btc\":{\"jpy\":");  o.num(s.btc > 0 ? s.btc : NAN, "%.0f");
+  o.str(",\"prev\":");         o.num(s.btcPrev > 0 ? s.btcPrev : NAN, "%.0f");
+  o.str(",\"change_24h_pct\":"); o.num(s.btcChange24h, "%.2f");
+  o.fmt(",\"rev\":%lu},", (unsigned long)s.btcRev);
+
+  o.str("\"rates\":"); o.jsonStr(s.ticker);
+
+  o.str(",\"news\":{");
+  for (int f = 0; f < SNAP_FEEDS; f++) {
+    if (f) o.put(',');
+    o.put('"'); o.str(SNAP_FEED_NAMES[f]);
+    o.fmt("\":{\"rev\":%lu,\"items\":[", (unsigned long)s.newsRev[f]);
+    char t[256];
+    uint32_t i = 0;
+    for (; i < s.newsCount[f] && s.headline && s.headline(f, s.newsRev[f], (int)i, t, sizeof(t)); i++) {
+      if (i) o.put(',');
+      o.jsonStr(t);
+    }
+    // false = 応答中にフィードが差し替わったので途中で打ち切った（items は旧 rev の先頭部分のみ）
+    o.fmt("],\"complete\":%s}", i == s.newsCount[f] ? "true" : "false");
+  }
+  o.str("},");
+
+  o.str("\"sensor\":{\"temperature_c\":"); o.num(s.temp, "%.2f");
+  o.str(",\"humidity_pct\":");             o.num(s.humid, "%.2f");
+  o.str(",\"pressure_hpa\":");             o.num(s.pressure, "%.2f");
+  o.str(",\"pressure_3h_hpa\":");          o.num(s.press3h, "%.2f");
+  o.str("},");
+
+  o.str("\"power\":{\"mode\":"); o.jsonStr(SNAP_POWER_MODE_NAMES[s.powerMode % SNAP_POWER_MODES]);
+  o.fmt(",\"brightness\":%u,\"wakeups_per_s\":", (unsigned)s.brightness);
+  o.num(s.powerWakes[s.powerMode % SNAP_POWER_MODES], "%.1f");
+  o.str(",\"est_mwh_per_hour\":"); o.num(s.powerMwh[s.powerMode % SNAP_POWER_MODES], "%.0f");
+  o.str("},");
+
+  o.fmt("\"wifi\":{\"connected\":%s,\"rssi\":%d}}\n", s.wifiOk ? "true" : "false", s.rssi);
+}
+
+// ===================== Prometheus テキスト =====================
+// 値は型ごとに桁を落とさず書く：整数は %lu / %ld（%g だと 1e6 以上が 1.23457e+06 に丸まり rate() が崩れる）、
+// double は %.17g、float は %.9g（どちらも元の値に戻せる桁数）
+template <class Sink>
+static void metricValue(ChunkOut<Sink>& o, uint32_t v) { o.fmt("%lu", (unsigned long)v); }
+template <class Sink>
+static void metricValue(ChunkOut<Sink>& o, int v)      { o.fmt("%ld", (long)v); }
+template <class Sink>
+static void metricValue(ChunkOut<Sink>& o, double v) {
+  if (isnan(v)) o.str("NaN");
+  else          o.fmt("%.17g", v);
+}
+template <class Sink>
+static void metricValue(ChunkOut<Sink>& o, float v) {
+  if (isnan(v)) o.str("NaN");
+  else          o.fmt("%.9g", (double)v);
+}
+
+template <class Sink, class T>
+static void writeMetric(ChunkOut<Sink>& o, const char* name, const char* type,
+                        const char* help, T v) {
+  o.str("# HELP okiclock_"); o.str(name); o.put(' '); o.str(help); o.put('\n');
+  o.str("# TYPE okiclock_"); o.str(name); o.put(' '); o.str(type); o.put('\n');
+  o.str("okiclock_"); o.str(name); o.put(' ');
+  metricValue(o, v);
+  o.put('\n');
+}
+
+template <class Sink>
+static void writeSrcMetric(ChunkOut<Sink>& o, const char* name, const char* type,
+                           const char* help, const uint32_t* v) {
+  o.str("# HELP okiclock_"); o.str(name); o.put(' '); o.str(help); o.put('\n');
+  o.str("# TYPE okiclock_"); o.str(name); o.put(' '); o.str(type); o.put('\n');
+  for (int i = 0; i < SRC_COUNT; i++) {
+    o.str("okiclock_"); o.str(name);
+    o.str("{source=\""); o.str(FETCH_SRC_NAMES[i]); o.str("\"} ");
+    o.fmt("%lu\n", (unsigned long)v[i]);
+  }
+}
+
+template <class Sink>
+static void writeFeedMetric(ChunkOut<Sink>& o, const char* name, const char* type,
+                            const char* help, const uint32_t* v) {
+  o.str("# HELP okiclock_"); o.str(name); o.put(' '); o.str(help); o.put('\n');
+  o.str("# TYPE okiclock_"); o.str(name); o.put(' '); o.str(type); o.put('\n');
+  for (int i = 0; i < SNAP_FEEDS; i++) {
+    o.str("okiclock_"); o.str(name);
+    o.str("{feed=\""); o.str(SNAP_FEED_NAMES[i]); o.str("\"} ");
+    o.fmt("%lu\n", (unsigned long)v[i]);
+  }
+}
+
+template <class Sink, class T>
+static void writeModeMetric(ChunkOut<Sink>& o, const char* name, const char* type,
+                            const char* help, const T* v) {
+  o.str("# HELP okiclock_"); o.str(name); o.put(' '); o.str(help); o.put('\n');
+  o.str("# TYPE okiclock_"); o.str(name); o.put(' '); o.str(type); o.put('\n');
+  for (int i = 0; i < SNAP_POWER_MODES; i++) {
+    o.str("okiclock_"); o.str(name);
+    o.str("{mode=\""); o.str(SNAP_POWER_MODE_NAMES[i]); o.str("\"} ");
+    metricValue(o, v[i]);
+    o.put('\n');
+  }
+}
+
+template <class Sink>
+static void writeMetricsText(ChunkOut<Sink>& o, const StatusSnapshot& s) {
+  writeMetric(o, "uptime_seconds",         "gauge",   "Seconds since boot.", s.uptimeMs / 1000);
+  writeMetric(o, "heap_free_bytes",        "gauge",   "Free heap.", s.heapFree);
+  writeMetric(o, "heap_min_free_bytes",    "gauge",   "Lowest free heap since boot.", s.heapMin);
+  writeMetric(o, "wifi_connected",         "gauge",   "1 if Wi-Fi is associated.", s.wifiOk ? 1 : 0);
+  writeMetric(o, "wifi_rssi_dbm",          "gauge",   "Wi-Fi RSSI.", s.wifiOk ? (double)s.rssi : NAN);
+  writeSrcMetric(o, "fetch_latency_ms",    "gauge",   "Duration of the last fetch.", s.fetchMs);
+  writeSrcMetric(o, "fetch_success_total", "counter", "Successful fetches.", s.fetchOk);
+  writeSrcMetric(o, "fetch_failures_total","counter", "Failed fetches.", s.fetchFail);
+  writeMetric(o, "upstream_requests_total","counter", "Requests sent to upstream APIs.", s.upstreamReqs);
+  writeMetric(o, "relay_role",             "gauge",   "0=off 1=server 2=client.", s.relayRole);
+  writeMetric(o, "relay_live",             "gauge",   "1 while relay deltas are arriving.", s.relayLive ? 1 : 0);
+  writeMetric(o, "relay_rx_packets_total", "counter", "Relay deltas applied.", s.relayRx);
+  writeMetric(o, "relay_tx_packets_total", "counter", "Relay packets sent.", s.relayTx);
+  writeMetric(o, "relay_delta_age_ms",     "gauge",   "Server-side age plus client apply time of the last relay delta (network transit not included).", s.relayAgeMs);
+  writeMetric(o, "relay_resyncs_total",    "counter", "Relay state dropped because the server restarted.", s.relayResyncs);
+  writeMetric(o, "clock_skew_us",          "gauge",   "Second edge to clock repaint done, last.", s.clockSkewUs);
+  writeMetric(o, "clock_skew_max_us",      "gauge",   "Second edge to clock repaint done, max.", s.clockSkewMaxUs);
+  writeMetric(o, "clock_skew_avg_us",      "gauge",   "Second edge to clock repaint done, EMA.", s.clockSkewAvgUs);
+  writeMetric(o, "clock_text_sec_only_total", "counter", "Clock text updates that rewrote only the seconds digits.", s.clockSecOnly);
+  writeMetric(o, "clock_text_full_total",  "counter", "Clock text updates that reformatted HH:MM:SS.", s.clockFull);
+  writeMetric(o, "clock_text_date_total",  "counter", "Date string reformats.", s.clockDateUpd);
+  writeMetric(o, "sprite_push_top_us",     "gauge",   "Last top sprite push incl. palette expansion.", s.pushTopUs);
+  writeMetric(o, "sprite_push_ticker_us",  "gauge",   "Last ticker sprite push incl. palette expansion.", s.pushTickerUs);
+  writeMetric(o, "sprite_push_news_us",    "gauge",   "Last push of all 4 news rows incl. palette expansion.", s.pushNewsUs);
+  writeMetric(o, "page_restore_us",        "gauge",   "Last page switch: cached static layer restore.", s.pageRestoreUs);
+  writeMetric(o, "page_switch_us",         "gauge",   "Last page switch: button press to fully drawn.", s.pageSwitchUs);
+  writeMetric(o, "page_switch_max_us",     "gauge",   "Page switch: button press to fully drawn, max since boot.", s.pageSwitchMaxUs);
+  writeMetric(o, "page_cache_bytes",       "gauge",   "RLE page layer cache size.", s.pageCacheBytes);
+  writeMetric(o, "headline_pool_used_bytes", "gauge", "Live headline text bytes in the pool.", s.newsPoolBytes);
+  writeMetric(o, "headline_pool_capacity_bytes", "gauge", "Headline pool size.", s.newsPoolCap);
+  writeMetric(o, "headline_entries",       "gauge",   "Distinct headlines stored.", s.newsEntries);
+  writeFeedMetric(o, "headline_count",     "gauge",   "Headlines currently shown per feed.", s.newsCount);
+  writeMetric(o, "news_rotate_us",         "gauge",   "Last news row rotation (copy + measure).", s.newsRotateUs);
+  writeMetric(o, "headline_watch_matches", "gauge",   "Stored headlines matching a watch keyword.", s.newsWatched);
+  writeMetric(o, "watch_keywords",         "gauge",   "Watch keywords compiled into the matcher.", s.watchKeywords);
+  writeMetric(o, "watch_dfa_states",       "gauge",   "Aho-Corasick automaton states.", s.watchStates);
+  writeMetric(o, "watch_table_bytes",      "gauge",   "Automaton transition and output tables.", s.watchTableBytes);
+  writeMetric(o, "power_mode",             "gauge",   "0=active 1=idle 2=night.", s.powerMode);
+  writeMetric(o, "power_brightness",       "gauge",   "Backlight level (0-255).", s.brightness);
+  writeMetric(o, "power_mode_transitions_total", "counter", "Power mode changes.", s.powerTransitions);
+  writeModeMetric(o, "power_mode_seconds_total", "counter", "Time spent in each power mode.", s.powerSec);
+  writeModeMetric(o, "power_wakeups_per_second", "gauge", "Task wake-ups per second in each mode (UI + net + http).", s.powerWakes);
+  writeModeMetric(o, "power_estimated_mwh_per_hour", "gauge", "Modelled average draw per mode (3.3V rail; placeholder coefficients, not calibrated for this board).", s.powerMwh);
+  writeMetric(o, "btc_jpy",                "gauge",   "Last BTC/JPY price.", s.btc > 0 ? s.btc : NAN);
+  writeMetric(o, "btc_change_24h_percent", "gauge",   "BTC/JPY change over the last 24h (15m resolution).", s.btcChange24h);
+  writeMetric(o, "btc_candle_closes_total","counter", "1-minute candles closed.", s.candleCloses);
+  writeMetric(o, "btc_chart_draw_us",      "gauge",   "Last mini chart redraw.", s.chartDrawUs);
+  writeMetric(o, "temperature_celsius",    "gauge",   "ENV III temperature.", s.temp);
+  writeMetric(o, "humidity_percent",       "gauge",   "ENV III relative humidity.", s.humid);
+  writeMetric(o, "pressure_hpa",           "gauge",   "ENV III pressure.", s.pressure);
+}
+
+// ===================== ルーティング =====================
+template <class Sink>
+static void serveStatusRequest(Sink& sink, const char* path, const StatusSnapshot& s) {
+  ChunkOut<Sink> o(sink);
+  if (strcmp(path, "/") == 0 || strcmp(path, "/status") == 0) {
+    httpWriteHeader(o, 200, "application/json");
+    writeStatusJson(o, s);
+  } else if (strcmp(path, "/metrics") == 0) {
+    httpWriteHeader(o, 200, "text/plain; version=0.0.4");
+    writeMetricsText(o, s);
+  } else {
+    httpWriteHeader(o, 404, "text/plain");
+    o.str("not found\n");
+  }
+}
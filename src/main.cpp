@@ -2,12 +2,23 @@
 #include <WiFi.h>
 #include <HTTPClient.h>
 #include <WiFiClientSecure.h>
+#include <WiFiUdp.h>
 #include <ArduinoJson.h>
 #include <time.h>
+#include <sys/time.h>
 #include <math.h>
 #include <M5UnitENV.h>
 
 #include "secrets.h"
+#include "SensorStats.h"
+#include "RelayProto.h"
+#include "StatusHttp.h"
+#include "ClockFormat.h"
+#include "RleLayer.h"
+#include "HeadlineStore.h"
+#include "KeywordMatcher.h"
+#include "Candles.h"
+#include "PowerGovernor.h"
 
 // ===================== 設定 =====================
 static const uint32_t BTC_UPDATE_MS   = 10 * 1000; // 10秒
@@ -15,10 +26,14 @@ static const uint32_t RSS_UPDATE_MS   = 60 * 1000; // 1分
 static const uint32_t WIFI_TIMEOUT_MS = 15 * 1000;
 static const uint32_t NTP_TIMEOUT_MS  = 8  * 1000;
 
-static const uint32_t TOP_UI_MS          = 250;  // 上段更新
-static const uint32_t NEWS_TICK_MS       = 33;   // ニューススクロール
+// ニューススクロールのコマ間隔・輝度・モデムスリープは省電力モードごと（PowerGovernor.h の POWER_PROFILES）
+// 1コマの移動量は ACTIVE（33ms/コマ）での値。コマ間隔が伸びた分だけ増やし、px/秒 を保つ（scrollStep）
 static const int      SCROLL_PX_PER_TICK = 2;
 static const int      TICKER_PX_PER_TICK = 6;    // 通貨ティッカー（高速）
+// 無操作で IDLE（減光・10fps）に落とすまでの ms。0 = 使わない（既定。夜間の NIGHT は時刻で決まる）
+#ifndef OKI_POWER_IDLE_MS
+#define OKI_POWER_IDLE_MS 0
+#endif
 static const uint32_t SENSOR_UPDATE_MS   = 2000; // センサー読み取り
 static const uint32_t RATES_UPDATE_MS    = 5 * 60 * 1000; // 為替レート（5分）
 
@@ -29,8 +44,30 @@ static const char* RSS_WORLD_URL    = "https://feeds.bbci.co.uk/news/world/rss.x
 static const char* RSS_BUSINESS_URL = "https://feeds.bbci.co.uk/news/business/rss.xml";
 static const char* RSS_TECH_URL     = "https://feeds.bbci.co.uk/news/technology/rss.xml";
 
-// バッファ（大きくしすぎると逆に危険。まずはこのくらい）
-static const size_t RSS_BUF_SZ = 520;
+// 1フィードあたりの見出し件数（本文は共有プールに格納：HeadlineStore.h）
+static const int RSS_MAX_ITEMS = HL_MAX_PER_FEED;
+
+// 注目キーワード（大文字小文字は無視）。一致した見出しは黄色で表示し、MIX 行に優先して流す。
+// 前後に空白を付けると単語単位で照合（" ai " は "said" に一致しない）。詳細は KeywordMatcher.h
+static const char* const WATCH_KEYWORDS[] = {
+  "bitcoin", " btc ", "crypto", "earthquake", "tsunami", "typhoon",
+  "japan", " yen ", "nikkei", "nvidia", "openai", " ai ",
+};
+static const int WATCH_KEYWORD_COUNT = sizeof(WATCH_KEYWORDS) / sizeof(WATCH_KEYWORDS[0]);
+
+// LANリレー（オプトイン）：1台を RELAY_SERVER にすると取得結果をマルチキャストで配信、
+// RELAY_CLIENT は配信を使い、途絶えたら直接取得に戻る。
+// 台ごとに build_flags（-DOKI_RELAY_ROLE=RELAY_CLIENT）か secrets.h で指定
+#ifndef OKI_RELAY_ROLE
+#define OKI_RELAY_ROLE RELAY_OFF
+#endif
+static const RelayRole RELAY_ROLE         = OKI_RELAY_ROLE;
+static const uint16_t  RELAY_PORT         = 41234; // 送受信の間隔は RelayProto.h
+static const IPAddress RELAY_GROUP(239, 77, 77, 1);
+
+// ステータス / メトリクス HTTP（GET / , /status , /metrics）
+static const uint16_t HTTP_PORT       = 80;
+static const uint32_t HTTP_READ_TO_MS = 1000; // リクエスト受信のタイムアウト
 
 // ===================== 共有状態（タスク間） =====================
 static SemaphoreHandle_t gMutex;
@@ -38,11 +75,13 @@ static SemaphoreHandle_t gMutex;
 static double   gBtc     = 0.0;
 static double   gBtcPrev = 0.0;
 static uint32_t gBtcRev  = 0;
+static BtcCandles gBtcCandles; // 1分/15分/1時間足（約3.3KB, 時刻同期後のみ集計）
 
-static char     gWorld[RSS_BUF_SZ]    = "(pending)";
-static char     gBusiness[RSS_BUF_SZ] = "(pending)";
-static char     gTech[RSS_BUF_SZ]     = "(pending)";
-static uint32_t gRssRev  = 0;
+// 見出し（固定長プール, 約9.2KB：3フィード×24件）。各行はここから1件ずつローテーション表示
+enum FeedState : uint8_t { FEED_FETCHING = 0, FEED_OK, FEED_FAILED };
+static HeadlineStore gNews;
+static uint8_t       gFeedState[HL_FEEDS] = {FEED_FETCHING, FEED_FETCHING, FEED_FETCHING};
+static KeywordMatcher gWatch; // setup で1回構築。照合は NetTask のみ
 
 static char     gTicker[512] = "(fetching rates...)";
 static uint32_t gTickerRev   = 0;
@@ -53,6 +92,38 @@ static float    gHumid    = NAN;
 static float    gPressure = NAN;
 static int      gPage     = 0; // 0=メイン, 1=センサー
 
+// センサー移動統計（5分/1時間/24時間, 約4KB×3）
+static SensorSeries gTempStats;
+static SensorSeries gHumidStats;
+static SensorSeries gPressStats;
+static int          gStatWin = WIN_5M; // ボタンBで切替
+
+// 取得 / リレー統計
+static uint32_t gFetchMs[SRC_COUNT]   = {}; // 直近の取得所要時間
+static uint32_t gFetchOk[SRC_COUNT]   = {};
+static uint32_t gFetchFail[SRC_COUNT] = {};
+static uint32_t gUpstreamReqs  = 0;     // 上流APIへのリクエスト数（リレー効果の確認用）
+static uint32_t gRelayRx       = 0;     // 受信して適用したパケット数
+static uint32_t gRelayTx       = 0;     // 送信パケット数
+static uint32_t gRelayAgeMs    = 0;     // 直近の差分の古さ（SERVER側の滞留 + CLIENT側の適用。網の伝送は含まない）
+static uint32_t gRelayResyncs  = 0;     // CLIENT: SERVER の再起動（epoch 変化）で取り直した回数
+static bool     gRelayLive     = false; // CLIENT: リレー受信中
+
+// 省電力（UiTask が判定し、他タスクは結果だけ読む）。gPower の参照・更新は gMutex の中で
+static PowerGovernor     gPower;
+static volatile bool     gPowerModemSleep = false;
+static volatile uint16_t gPowerNetLoopMs  = POWER_PROFILES[PWR_ACTIVE].netLoopMs;
+static volatile uint32_t gNetWakes  = 0; // NetTask の起床回数（UiTask が差分を回収）
+static volatile uint32_t gHttpWakes = 0; // HttpTask 〃
+static volatile uint32_t gSensorWakes = 0; // SensorTask 〃
+
+// 時計表示のずれ（秒の切り替わり → 上段の転送完了まで）
+static uint32_t gClockSkewUs    = 0;
+static uint32_t gClockSkewMaxUs = 0;
+static uint32_t gClockSkewAvgUs = 0; // 指数移動平均（1/16）
+// 時計文字列の更新内訳（gClock は UiTask 専用なのでここへ写す）
+static uint32_t gClockSecOnly = 0, gClockFull = 0, gClockDateUpd = 0;
+
 static SHT3X   gSht3x;
 static QMP6988 gQmp6988;
 
@@ -70,11 +141,37 @@ static const uint16_t BG_NEWS   = 0x0842; // ニュース背景（さらに暗
 static const uint16_t C_ACCENT  = 0x05FA; // シアンアクセント
 static const uint16_t C_DIM     = 0x3A8D; // 薄いテキスト
 
+// スプライト共有パレット（4bit=16色）。スプライトへの描画色はこの番号で指定し、
+// pushSprite 時に下の LUT で RGB565 へ展開される（フレームバッファは 1/4）
+enum PalIdx : uint8_t {
+  PI_BG_TOP = 0, PI_BG_PANEL, PI_BG_NEWS, PI_BG_NEWS2, PI_ACCENT, PI_DIM,
+  PI_WHITE, PI_YELLOW, PI_GREEN, PI_RED, PI_ORANGE, PI_CYAN, PI_MAGENTA,
+  PI_NEUTRAL, PI_GREEN_MID, PI_RED_MID,
+  PI_COUNT
+};
+static const uint16_t PALETTE[PI_COUNT] = {
+  BG_TOP, BG_PANEL, BG_NEWS, (uint16_t)(BG_NEWS + 0x0020), C_ACCENT, C_DIM,
+  0xFFFF, 0xFFE0, 0x07E0, 0xF800, 0xFD20, 0x07FF, 0xF81F,
+  0x18E3, 0x0C61, 0x8861, // BTC変化バー：灰(30,30,30) / 中間の緑・赤
+};
+
 static const int LINE0_Y  = 0;
 static const int LINE0_H  = 18;
 static const int CLK_X    = 220; // 右上に時計
 static const int BADGE_W  = 70;  // ニュースバッジ幅
 
+// BTC行：価格（size2, x=10..）| 変化率2行（size1）| ミニチャート
+//   価格は "BTC " + 9桁 = 13文字 × 12px で x=166 まで。変化率は "24h +999.99%" = 12文字 × 6px = 72px
+static const int BTC_PRICE_X = 10;
+static const int BTC_PCT_X   = 170;
+static const int BTC_PRICE_W = BTC_PCT_X - 4 - BTC_PRICE_X; // 価格に使える幅
+// ミニチャート（1本 = 1px幅の足 + 1px間隔）
+static const int CHART_X     = BTC_PCT_X + 74;
+static const int CHART_Y     = 46;
+static const int CHART_H     = 24;
+static const int CHART_PITCH = 2;
+static const int CHART_N     = (320 - CHART_X) / CHART_PITCH; // 38本
+
 // ===================== 便利関数 =====================
 static bool isTimeValid() {
   time_t now = time(nullptr);
@@ -83,49 +180,45 @@ static bool isTimeValid() {
 static void startNtpJST() {
   configTzTime("JST-9", "ntp.nict.jp", "pool.ntp.org", "time.google.com");
 }
-static String clockText() {
-  if (isTimeValid()) {
-    struct tm tminfo;
-    if (getLocalTime(&tminfo, 0)) {
-      char buf[16];
-      strftime(buf, sizeof(buf), "%H:%M:%S", &tminfo);
-      return String(buf);
-    }
+// 表示上の「現在の秒」と、その秒に入ってからの経過µs（NTP未同期なら起動からの秒）
+static time_t displaySecond(bool& synced, uint32_t& usIntoSec) {
+  synced = isTimeValid();
+  if (synced) {
+    struct timeval tv;
+    gettimeofday(&tv, nullptr);
+    usIntoSec = (uint32_t)tv.tv_usec;
+    return tv.tv_sec;
   }
-  uint32_t s = millis() / 1000;
-  uint32_t hh = (s / 3600) % 100, mm = (s / 60) % 60, ss = s % 60;
-  char buf[16];
-  snprintf(buf, sizeof(buf), "%02lu:%02lu:%02lu",
-           (unsigned long)hh, (unsigned long)mm, (unsigned long)ss);
-  return String(buf);
-}
-static String dateTimeJST() {
-  if (!isTimeValid()) return "----/--/-- --:--:--";
-  struct tm tminfo;
-  if (!getLocalTime(&tminfo, 0)) return "----/--/-- --:--:--";
-  char buf[32];
-  strftime(buf, sizeof(buf), "%Y/%m/%d %H:%M:%S", &tminfo);
-  return String(buf);
-}
-
-static uint16_t lerp565(uint8_t r0, uint8_t g0, uint8_t b0,
-                        uint8_t r1, uint8_t g1, uint8_t b1,
-                        float t)
-{
-  if (t < 0) t = 0;
-  if (t > 1) t = 1;
-  uint8_t r = (uint8_t)(r0 + (r1 - r0) * t);
-  uint8_t g = (uint8_t)(g0 + (g1 - g0) * t);
-  uint8_t b = (uint8_t)(b0 + (b1 - b0) * t);
-  return M5.Display.color565(r, g, b);
-}
-static uint16_t btcBorderColorFromChange(double prev, double now) {
-  if (prev <= 0.0 || now <= 0.0) return WHITE;
+  uint32_t ms = millis();
+  usIntoSec = (ms % 1000) * 1000;
+  return (time_t)(ms / 1000);
+}
+
+static uint32_t minU32(uint32_t a, uint32_t b) { return a < b ? a : b; }
+
+// last から period 経過するまでの残り ms（過ぎていれば 0）
+static uint32_t untilDue(uint32_t last, uint32_t period, uint32_t now) {
+  uint32_t el = now - last;
+  return el >= period ? 0 : period - el;
+}
+
+// 変化率 → パレット番号（灰 → 中間 → 緑/赤 の3段階）
+static uint8_t btcBorderColorFromChange(double prev, double now) {
+  if (prev <= 0.0 || now <= 0.0) return PI_WHITE;
   double ch = (now - prev) / prev;
   double mag = fabs(ch);
   float t = (float)(mag / 0.005); // 0.5%で最大
-  if (t > 1.0f) t = 1.0f;
-  return (ch >= 0.0) ? lerp565(30,30,30, 0,255,0, t) : lerp565(30,30,30, 255,0,0, t);
+  if (t < 0.25f) return PI_NEUTRAL;
+  if (t < 0.75f) return (ch >= 0.0) ? PI_GREEN_MID : PI_RED_MID;
+  return (ch >= 0.0) ? PI_GREEN : PI_RED;
+}
+
+// "24h +1.23%" / "24h --"。|v| >= 1000 は小数を落として12文字（72px）以内に収める
+static const char* fmtPctLabel(char* out, size_t outsz, const char* label, float v) {
+  if (isnan(v))                 snprintf(out, outsz, "%s --", label);
+  else if (fabsf(v) < 999.995f) snprintf(out, outsz, "%s %+.2f%%", label, v);
+  else                          snprintf(out, outsz, "%s %+.0f%%", label, v);
+  return out;
 }
 
 // WiFiシグナル強度をバー数(0-4)に変換
@@ -138,13 +231,13 @@ static int rssiToBars(int rssi) {
 
 // WiFiシグナルバー描画（スプライト用）
 static void drawWifiBars(M5Canvas& c, int x, int y, int bars) {
-  static const uint16_t BARCOLS[] = {C_DIM, 0xF800, 0xFD20, 0xFFE0, 0x07E0};
-  uint16_t activeCol = BARCOLS[bars];
+  static const uint8_t BARCOLS[] = {PI_DIM, PI_RED, PI_ORANGE, PI_YELLOW, PI_GREEN};
+  uint8_t activeCol = BARCOLS[bars];
   for (int b = 0; b < 4; b++) {
     int bh = 6 + b * 3;
     int bx = x + b * 7;
     int by = y - bh;
-    c.fillRect(bx, by, 5, bh, (b < bars) ? activeCol : C_DIM);
+    c.fillRect(bx, by, 5, bh, (b < bars) ? activeCol : (uint8_t)PI_DIM);
   }
 }
 
@@ -220,10 +313,8 @@ static void decodeEntities(String& s) {
   s.replace("&#39;", "'");
 }
 
-static bool fetchRssTitlesStreamToBuf(const char* url, char* dst, size_t dstsz, int maxItems = 4) {
-  if (!dst || dstsz == 0) return false;
-  dst[0] = '\0';
-
+// 見出しを1件ずつ gNews の取得中リストへ追加し、1件以上取れたら差し替える
+static bool fetchRssTitlesStream(const char* url, int feed, int maxItems = RSS_MAX_ITEMS) {
   WiFiClientSecure client;
   HTTPClient http;
 
@@ -244,9 +335,14 @@ static bool fetchRssTitlesStreamToBuf(const char* url, char* dst, size_t dstsz,
   int miS=0, miE=0, mtS=0, mtE=0;
   bool inItem=false, inTitle=false;
   String title; title.reserve(180);
-  String joined; joined.reserve(dstsz-1);
+  KwTags tags;  // 注目キーワード：本文の各バイトをその場で照合
+  KwTextFilter kwText; // 照合は表示と同じ文字列で（タグ除去・実体参照の展開を1バイトずつ）
   int count=0;
 
+  xSemaphoreTake(gMutex, portMAX_DELAY);
+  gNews.beginFeed(feed);
+  xSemaphoreGive(gMutex);
+
   // inTitle中に "</title>" の判定をするための小バッファ
   String endbuf; endbuf.reserve(10);
   bool checkingEnd=false;
@@ -267,6 +363,8 @@ static bool fetchRssTitlesStreamToBuf(const char* url, char* dst, size_t dstsz,
       if (P_TIT_S[mtS] == '\0') {
         inTitle = true;
         title = "";
+        gWatch.beginText(tags);
+        kwText.begin();
         checkingEnd = false;
         endbuf = "";
         mtS = 0;
@@ -284,6 +382,7 @@ static bool fetchRssTitlesStreamToBuf(const char* url, char* dst, size_t dstsz,
           continue;
         } else {
           if (title.length() < 220) title += c;
+          kwText.feed(c, gWatch, tags);
           continue;
         }
       } else {
@@ -297,6 +396,8 @@ static bool fetchRssTitlesStreamToBuf(const char* url, char* dst, size_t dstsz,
             inTitle = false;
             checkingEnd = false;
             mtE = 0;
+            kwText.end(gWatch, tags);
+            gWatch.endText(tags);
             // 整形して追加（タグ除去→エンティティ展開→ASCII変換の順）
             stripHtmlTags(title);
             decodeEntities(title);
@@ -305,9 +406,10 @@ static bool fetchRssTitlesStreamToBuf(const char* url, char* dst, size_t dstsz,
             title.trim();
 
             if (title.length()) {
-              if (joined.length()) joined += "  |  ";
-              joined += title;
-              count++;
+              xSemaphoreTake(gMutex, portMAX_DELAY);
+              bool added = gNews.add(feed, title.c_str(), title.length(), &tags);
+              xSemaphoreGive(gMutex);
+              if (added) count++;
             }
             if (count >= maxItems) break;
             continue;
@@ -320,6 +422,8 @@ static bool fetchRssTitlesStreamToBuf(const char* url, char* dst, size_t dstsz,
           if (title.length() + endbuf.length() < 240) title += endbuf;
           // 現在の文字も本文へ
           if (title.length() < 240) title += c;
+          kwText.feed(endbuf.c_str(), endbuf.length(), gWatch, tags);
+          kwText.feed(c, gWatch, tags);
           continue;
         }
       }
@@ -328,10 +432,12 @@ static bool fetchRssTitlesStreamToBuf(const char* url, char* dst, size_t dstsz,
 
   http.end();
 
-  if (count <= 0) return false;
-  sanitizeUtf8ToAscii(joined);
-  snprintf(dst, dstsz, "%s", joined.c_str());
-  return true;
+  // 1件も取れなければ旧リストを残す
+  xSemaphoreTake(gMutex, portMAX_DELAY);
+  if (count > 0) gNews.commitFeed(feed);
+  else           gNews.abortFeed(feed);
+  xSemaphoreGive(gMutex);
+  return count > 0;
 }
 
 // ===================== BTC =====================
@@ -400,9 +506,23 @@ static bool fetchRates(char* dst, size_t dstsz) {
 }
 
 // ===================== UI：スプライト =====================
-static M5Canvas topSpr   (&M5.Display); // 320x72  上段用
-static M5Canvas tickerSpr(&M5.Display); // 320x20  通貨ティッカー
-static M5Canvas newsSpr  (&M5.Display); // 250x37  ニュース1段分
+// すべて 4bit パレット（RGB565 比 1/4）：合計 約19KB（旧 約77KB）
+static M5Canvas topSpr   (&M5.Display); // 320x72  上段用        11520B
+static M5Canvas tickerSpr(&M5.Display); // 320x20  通貨ティッカー  3200B
+static M5Canvas newsSpr  (&M5.Display); // 250x37  ニュース1段分   4625B
+
+static bool createPaletteSprite(M5Canvas& spr, int w, int h) {
+  spr.setColorDepth(4);
+  if (!spr.createSprite(w, h)) return false;
+  spr.createPalette();
+  for (int i = 0; i < PI_COUNT; i++) {
+    uint16_t c = PALETTE[i];
+    spr.setPaletteColor(i, (uint8_t)(((c >> 11) & 0x1F) * 255 / 31),
+                           (uint8_t)(((c >> 5)  & 0x3F) * 255 / 63),
+                           (uint8_t)(( c        & 0x1F) * 255 / 31));
+  }
+  return true;
+}
 
 // ティッカースクロール状態（UiTaskのみアクセス）
 static String   tickerText          = "";
@@ -410,57 +530,121 @@ static int      tickerX             = 320;
 static int      tickerW             = 0;
 static uint32_t lastSeenTickerRev   = 0xFFFFFFFF;
 
+// ニュース行：1行に1見出しを流し、画面外に出たら次の見出しへ（UiTaskのみアクセス）
+static const uint8_t NEWS_ROW_COLS[4] = {PI_CYAN, PI_ORANGE, PI_MAGENTA, PI_WHITE}; // WORLD/BIZ/TECH/MIX
+static const int     WATCH_LABEL_MAX  = 16; // MIX 行の "[KEYWORD] " 接頭辞（"[EARTHQUAKE] " が入る長さ）
+
 struct NewsLine {
-  String text;
-  int x = 320;
-  int w = 0;
-  uint16_t color = WHITE;
+  char     text[WATCH_LABEL_MAX + HL_TEXT_MAX + 1] = "";
+  int      x     = 250;
+  int      w     = 0;
+  uint8_t  color = PI_WHITE; // パレット番号（注目見出しは PI_YELLOW）
+  uint16_t next  = 0;        // 次に表示する項目（MIX は フィード×件数 の通し番号）
+  uint16_t pin   = 0;        // MIX：次に探す注目見出し（同じ通し番号）
 };
 static NewsLine lines[4];
-static uint32_t lastSeenRssRev = 0;
+static ClockText gClock; // 上段の時計文字列（差分更新）
+
+// 直近の pushSprite 所要時間（パレット展開込み, µs）。UiTaskのみ書き込む32bit値なのでロック不要
+enum SprId : uint8_t { SPR_TOP = 0, SPR_TICKER, SPR_NEWS, SPR_COUNT };
+static volatile uint32_t gPushUs[SPR_COUNT] = {};
+// ページ切替：静的レイヤー復元 / ボタン押下から全描画完了まで（µs）
+static volatile uint32_t gPageRestoreUs = 0;
+static volatile uint32_t gPageSwitchUs  = 0;
+static volatile uint32_t gPageSwitchMaxUs = 0;
+// 直近のニュース行ローテーション（見出しコピー + 幅計算, µs）
+static volatile uint32_t gNewsRotateUs  = 0;
+// 直近のミニチャート描き直し（µs）
+static volatile uint32_t gChartDrawUs   = 0;
+
+// ミニチャート（BtnA で足の種類を切替）。描いた時の rev を覚えておき、変化がなければ topSpr 上の絵をそのまま使う
+static int      gChartTf       = TF_1M;
+static int      gChartDrawnTf  = -1;
+static uint32_t gChartDrawnRev = 0;
+static float    gChartPct      = NAN;  // 表示中の足の範囲での変化率
+
+// 未取得 / 失敗時の表示
+static void feedPlaceholder(int feed, char* out, size_t outsz) {
+  static const char* NAMES[HL_FEEDS] = {"WORLD", "BUSINESS", "TECH"};
+  if (gFeedState[feed] == FEED_FAILED) snprintf(out, outsz, "(%s failed)", NAMES[feed]);
+  else                                 snprintf(out, outsz, "(fetching...)");
+}
 
-static String firstItem(const char* s) {
-  if (!s) return "";
-  String ss = String(s);
-  int p = ss.indexOf("  |  ");
-  if (p < 0) return ss;
-  return ss.substring(0, p);
+// "[KEYWORD] "（前後の空白を除いて大文字化）。戻り値 = 書いた長さ
+static size_t watchLabel(uint16_t id, char* out, size_t outsz) {
+  if (id >= WATCH_KEYWORD_COUNT || outsz < 4) { if (outsz) out[0] = '\0'; return 0; }
+  const char* k = WATCH_KEYWORDS[id];
+  while (*k == ' ') k++;
+  size_t n = 0;
+  out[n++] = '[';
+  for (; *k && n + 3 < outsz; k++) out[n++] = (char)toupper((unsigned char)*k);
+  while (n > 1 && out[n - 1] == ' ') n--;
+  out[n++] = ']'; out[n++] = ' '; out[n] = '\0';
+  return n;
 }
 
-static void rebuild4LinesIfNeeded() {
-  uint32_t rev;
-  char wbuf[RSS_BUF_SZ], bbuf[RSS_BUF_SZ], tbuf[RSS_BUF_SZ];
+// 行 row の次の見出しを読み込む。row 0-2 は各フィード、row 3 (MIX) は3フィードを交互に。
+// 注目見出しがある間は MIX 行にそれだけを順に流す（ピン留め）
+static void loadNextHeadline(int row) {
+  uint32_t t0 = micros();
+  NewsLine& L = lines[row];
+  bool watched = false;
 
   xSemaphoreTake(gMutex, portMAX_DELAY);
-  rev = gRssRev;
-  snprintf(wbuf, sizeof(wbuf), "%s", gWorld);
-  snprintf(bbuf, sizeof(bbuf), "%s", gBusiness);
-  snprintf(tbuf, sizeof(tbuf), "%s", gTech);
+  if (row < HL_FEEDS) {
+    int n = gNews.count(row);
+    if (n == 0) {
+      feedPlaceholder(row, L.text, sizeof(L.text));
+    } else {
+      int i = L.next % n;
+      gNews.copy(row, i, L.text, sizeof(L.text));
+      watched = gNews.tags(row, i).any();
+      L.next = (uint16_t)(i + 1);
+    }
+  } else {
+    int maxN = 0;
+    for (int f = 0; f < HL_FEEDS; f++) if (gNews.count(f) > maxN) maxN = gNews.count(f);
+    if (maxN == 0) {
+      snprintf(L.text, sizeof(L.text), "(fetching...)");
+    } else {
+      const int total = maxN * HL_FEEDS;
+      for (int k = 0; k < total; k++) {
+        int seq = (L.pin + k) % total;
+        int f = seq % HL_FEEDS, i = seq / HL_FEEDS;
+        if (i >= gNews.count(f) || !gNews.tags(f, i).any()) continue;
+        size_t n = watchLabel(gNews.tags(f, i).id[0], L.text, WATCH_LABEL_MAX);
+        gNews.copy(f, i, L.text + n, sizeof(L.text) - n);
+        L.pin = (uint16_t)(seq + 1);
+        watched = true;
+        break;
+      }
+      for (int k = 0; !watched && k < total; k++) {
+        int seq = (L.next + k) % total;
+        int f = seq % HL_FEEDS, i = seq / HL_FEEDS;
+        if (i >= gNews.count(f)) continue;
+        gNews.copy(f, i, L.text, sizeof(L.text));
+        L.next = (uint16_t)(seq + 1);
+        break;
+      }
+    }
+  }
   xSemaphoreGive(gMutex);
-
-  if (rev == lastSeenRssRev) return;
-  lastSeenRssRev = rev;
-
-  // バッジにカテゴリを表示するのでテキストにプレフィックス不要
-  lines[0].text = String(wbuf);
-  lines[1].text = String(bbuf);
-  lines[2].text = String(tbuf);
-  lines[3].text = firstItem(wbuf) + "  //  " + firstItem(bbuf) + "  //  " + firstItem(tbuf);
-
-  lines[0].color = 0x07FF; // CYAN
-  lines[1].color = 0xFD20; // ORANGE
-  lines[2].color = 0xF81F; // MAGENTA
-  lines[3].color = 0xFFFF; // WHITE
+  L.color = watched ? (uint8_t)PI_YELLOW : NEWS_ROW_COLS[row];
 
   newsSpr.setTextSize(2);
-  for (int i = 0; i < 4; i++) {
-    lines[i].w = newsSpr.textWidth(lines[i].text.c_str());
-    if (lines[i].w < 1) lines[i].w = lines[i].text.length() * 12;
-    lines[i].x = 250; // スプライト幅（右端から開始）
-  }
+  L.w = newsSpr.textWidth(L.text);
+  if (L.w < 1) L.w = strlen(L.text) * 12;
+  L.x = 250; // スプライト幅（右端から開始）
+  gNewsRotateUs = micros() - t0;
 }
 
-static void drawTicker() {
+// コマ間隔 frameMs での1コマの移動量（ACTIVE のコマ間隔を基準に比例）
+static int scrollStep(int pxPerTick, uint16_t frameMs) {
+  const int base = POWER_PROFILES[PWR_ACTIVE].frameMs;
+  return (pxPerTick * frameMs + base / 2) / base;
+}
+
+static void drawTicker(int stepPx) {
   // データ更新チェック
   uint32_t rev;
   xSemaphoreTake(gMutex, portMAX_DELAY);
@@ -480,191 +664,339 @@ static void drawTicker() {
     tickerX = 320;
   }
 
-  tickerSpr.fillSprite(BG_PANEL);
+  tickerSpr.fillSprite(PI_BG_PANEL);
   // 上下の細ライン（ティッカー感）
-  tickerSpr.drawFastHLine(0, 0,           320, C_DIM);
-  tickerSpr.drawFastHLine(0, TICKER_H - 1, 320, C_DIM);
+  tickerSpr.drawFastHLine(0, 0,           320, PI_DIM);
+  tickerSpr.drawFastHLine(0, TICKER_H - 1, 320, PI_DIM);
   // スクロールテキスト
   tickerSpr.setTextSize(2);
-  tickerSpr.setTextColor(C_ACCENT, BG_PANEL);
+  tickerSpr.setTextColor(PI_ACCENT, PI_BG_PANEL);
   tickerSpr.setCursor(tickerX, 2);
   tickerSpr.print(tickerText);
+  uint32_t t0 = micros();
   tickerSpr.pushSprite(0, TICKER_Y);
+  gPushUs[SPR_TICKER] = micros() - t0;
 
-  tickerX -= TICKER_PX_PER_TICK;
+  tickerX -= stepPx;
   if (tickerX < -tickerW) tickerX = 320;
 }
 
-static void drawStaticUI() {
-  M5.Display.fillScreen(BG_TOP);
+// メインページの静的部分（キャッシュ生成時にキャンバスへ描く）
+static void drawStaticUI(M5Canvas& g) {
+  g.fillSprite(PI_BG_TOP);
 
   // ニュースエリア背景
-  M5.Display.fillRect(0, NEWS_Y, 320, NEWS_H, BG_NEWS);
+  g.fillRect(0, NEWS_Y, 320, NEWS_H, PI_BG_NEWS);
 
   // アクセントライン
-  M5.Display.drawFastHLine(0, TOP_H - 1, 320, C_ACCENT);
+  g.drawFastHLine(0, TOP_H - 1, 320, PI_ACCENT);
 
-  // ニュースバッジエリア（静的：1回だけ描画）
+  // ニュースバッジエリア
   static const char* LABELS[]  = {"WORLD", "BIZ  ", "TECH ", "MIX  "};
-  static const uint16_t BCOLS[] = {0x07FF, 0xFD20, 0xF81F, 0xFFFF}; // CYAN/ORANGE/MAGENTA/WHITE
+  const uint8_t* BCOLS = NEWS_ROW_COLS;
 
   for (int i = 0; i < 4; i++) {
     int y = NEWS_Y + i * 37;
-    M5.Display.fillRect(0, y, BADGE_W, 36, BG_PANEL);     // バッジ背景
-    M5.Display.fillRect(0, y, 5,       36, BCOLS[i]);      // 左カラーバー
-    M5.Display.drawFastVLine(BADGE_W, y, 36, C_DIM);       // 右境界線
-    M5.Display.setTextSize(2);
-    M5.Display.setTextColor(BCOLS[i], BG_PANEL);
-    M5.Display.setCursor(9, y + 10);
-    M5.Display.print(LABELS[i]);
+    g.fillRect(0, y, BADGE_W, 36, PI_BG_PANEL);     // バッジ背景
+    g.fillRect(0, y, 5,       36, BCOLS[i]);        // 左カラーバー
+    g.drawFastVLine(BADGE_W, y, 36, PI_DIM);        // 右境界線
+    g.setTextSize(2);
+    g.setTextColor(BCOLS[i], PI_BG_PANEL);
+    g.setCursor(9, y + 10);
+    g.print(LABELS[i]);
   }
 }
 
+// k[0..n) を右詰めで描く。高値-安値をヒゲ(DIM)、始値-終値を実体(緑/赤)として同じ1px列に重ねる
+static void drawBtcChart(const Candle* k, int n) {
+  uint32_t t0 = micros();
+  topSpr.fillRect(CHART_X, 44, 320 - CHART_X, 28, PI_BG_PANEL);
+  gChartPct = NAN;
+  if (n == 0) {
+    topSpr.setTextSize(1);
+    topSpr.setTextColor(PI_DIM);
+    topSpr.setCursor(CHART_X + 4, CHART_Y + 8);
+    topSpr.print("(no data)");
+    gChartDrawUs = micros() - t0;
+    return;
+  }
+
+  float lo = k[0].l, hi = k[0].h;
+  for (int i = 1; i < n; i++) {
+    if (k[i].l < lo) lo = k[i].l;
+    if (k[i].h > hi) hi = k[i].h;
+  }
+  const float scale = (hi > lo) ? (CHART_H - 1) / (hi - lo) : 0.0f;
+  auto yOf = [&](float v) { return CHART_Y + (CHART_H - 1) - (int)((v - lo) * scale + 0.5f); };
+
+  int x = 320 - n * CHART_PITCH;
+  for (int i = 0; i < n; i++, x += CHART_PITCH) {
+    const Candle& c = k[i];
+    int yh = yOf(c.h), yl = yOf(c.l);
+    topSpr.drawFastVLine(x, yh, yl - yh + 1, PI_DIM);
+    int yo = yOf(c.o), yc = yOf(c.c);
+    uint8_t col = (c.c > c.o) ? PI_GREEN : (c.c < c.o) ? PI_RED : PI_DIM;
+    topSpr.drawFastVLine(x, yo < yc ? yo : yc, abs(yo - yc) + 1, col);
+  }
+  if (k[0].o > 0.0f) gChartPct = (k[n - 1].c - k[0].o) / k[0].o * 100.0f;
+  gChartDrawUs = micros() - t0;
+}
+
 static void drawTopDynamic() {
-  topSpr.fillSprite(BG_TOP);
+  // ミニチャート部分（BTC行の右端）は描き直す時だけ塗る
+  topSpr.fillRect(0, 0, 320, 44, PI_BG_TOP);
 
   const bool wifiOk = (WiFi.status() == WL_CONNECTED);
   int rssi = wifiOk ? WiFi.RSSI() : 0;
 
   // ── ステータスバー (y=0..21) ──
-  topSpr.fillRect(0, 0, 320, 22, BG_PANEL);
+  topSpr.fillRect(0, 0, 320, 22, PI_BG_PANEL);
 
   // WiFiシグナルバー (x=4, 下端y=17)
   drawWifiBars(topSpr, 4, 17, wifiOk ? rssiToBars(rssi) : 0);
 
   // RSSI数値
   topSpr.setTextSize(1);
-  topSpr.setTextColor(wifiOk ? 0x07E0 : 0xF800);
+  topSpr.setTextColor(wifiOk ? PI_GREEN : PI_RED);
   topSpr.setCursor(34, 7);
   if (wifiOk) topSpr.printf("%ddBm", rssi);
   else        topSpr.print("--");
 
   // 時計（右上）
   topSpr.setTextSize(2);
-  topSpr.setTextColor(WHITE);
+  topSpr.setTextColor(PI_WHITE);
   topSpr.setCursor(CLK_X, 3);
-  topSpr.print(clockText());
+  topSpr.print(gClock.hms);
 
   // ステータスバー下線
-  topSpr.drawFastHLine(0, 21, 320, C_ACCENT);
+  topSpr.drawFastHLine(0, 21, 320, PI_ACCENT);
 
   // ── 日付行 (y=22..43) ──
   topSpr.setTextSize(2);
-  topSpr.setTextColor(C_DIM);
+  topSpr.setTextColor(PI_DIM);
   topSpr.setCursor(4, 25);
-  topSpr.print(dateTimeJST());
+  if (gClock.valid) { topSpr.print(gClock.ymd); topSpr.print(' '); topSpr.print(gClock.hms); }
+  else              topSpr.print("----/--/-- --:--:--");
 
   // 日付下線
-  topSpr.drawFastHLine(0, 43, 320, C_ACCENT);
+  topSpr.drawFastHLine(0, 43, 320, PI_ACCENT);
 
-  // ── BTC行 (y=44..71) ──
-  topSpr.fillRect(0, 44, 320, 28, BG_PANEL);
+  // ── BTC行 (y=44..71)：価格 | 24h / チャート範囲の変化率 | ミニチャート ──
+  topSpr.fillRect(0, 44, CHART_X, 28, PI_BG_PANEL);
 
+  static Candle tail[CHART_N];
   double btc, prev;
-  uint32_t rev;
+  float  ch24;
+  int    nTail = -1;
   xSemaphoreTake(gMutex, portMAX_DELAY);
-  btc = gBtc; prev = gBtcPrev; rev = gBtcRev;
+  btc = gBtc; prev = gBtcPrev;
+  ch24 = gBtcCandles.change24hPct();
+  uint32_t crev = gBtcCandles.rev(gChartTf);
+  if (gChartTf != gChartDrawnTf || crev != gChartDrawnRev) {
+    nTail = candleTail(gBtcCandles, gChartTf, tail, CHART_N);
+    gChartDrawnTf = gChartTf; gChartDrawnRev = crev;
+  }
   xSemaphoreGive(gMutex);
+  if (nTail >= 0) drawBtcChart(tail, nTail);
 
-  uint16_t btcAccent = btcBorderColorFromChange(prev, btc);
-  topSpr.fillRect(0, 44, 5, 28, btcAccent); // 左カラーバー
-
-  char bline[56];
-  if (btc > 0.0 && prev > 0.0) {
-    double ch = (btc - prev) / prev * 100.0;
-    char arrow = (ch >= 0) ? '^' : 'v';
-    snprintf(bline, sizeof(bline), "BTC/JPY %c %.0f (%+.2f%%)", arrow, btc, ch);
-  } else if (btc > 0.0) {
-    snprintf(bline, sizeof(bline), "BTC/JPY  %.0f", btc);
-  } else {
-    snprintf(bline, sizeof(bline), "BTC/JPY  (pending)");
-  }
+  uint8_t btcAccent = btcBorderColorFromChange(prev, btc);
+  topSpr.fillRect(0, 44, 5, 28, btcAccent); // 左カラーバー（直前の値からの変化）
 
+  char bline[32];
+  if (btc > 0.0) snprintf(bline, sizeof(bline), "BTC %.0f", btc);
+  else           snprintf(bline, sizeof(bline), "BTC ---");
+  if ((int)strlen(bline) * 12 > BTC_PRICE_W) snprintf(bline, sizeof(bline), "BTC %.0fM", btc / 1e6); // 10桁以上は百万円単位
   topSpr.setTextSize(2);
-  topSpr.setTextColor(0xFFE0); // YELLOW
-  topSpr.setCursor(10, 50);
+  topSpr.setTextColor(PI_YELLOW);
+  topSpr.setCursor(BTC_PRICE_X, 50);
   topSpr.print(bline);
 
+  char pline[24];
+  topSpr.setTextSize(1);
+  topSpr.setCursor(BTC_PCT_X, 48);
+  topSpr.setTextColor(isnan(ch24) ? PI_DIM : ch24 >= 0 ? PI_GREEN : PI_RED);
+  topSpr.print(fmtPctLabel(pline, sizeof(pline), "24h", ch24));
+  topSpr.setCursor(BTC_PCT_X, 60);
+  topSpr.setTextColor(PI_DIM);
+  topSpr.print(fmtPctLabel(pline, sizeof(pline), CANDLE_TF_LABELS[gChartTf], gChartPct));
+
+  uint32_t t0 = micros();
   topSpr.pushSprite(0, 0);
-  (void)rev;
+  gPushUs[SPR_TOP] = micros() - t0;
 }
 
-static void drawNews4Lines() {
+static void drawNews4Lines(int stepPx) {
   const int lineH  = 37;
   const int startY = NEWS_Y;
 
   newsSpr.setTextWrap(false);
   newsSpr.setTextSize(2);
 
+  uint32_t pushUs = 0;
   for (int i = 0; i < 4; i++) {
     // 偶数行/奇数行で背景色を微妙に変えて視認性UP
-    uint16_t rowBg = (i % 2 == 0) ? BG_NEWS : (uint16_t)(BG_NEWS + 0x0020);
+    uint8_t rowBg = (i % 2 == 0) ? PI_BG_NEWS : PI_BG_NEWS2;
     newsSpr.fillSprite(rowBg);
     newsSpr.setTextColor(lines[i].color, rowBg);
     newsSpr.setCursor(lines[i].x, 13); // 42px中央寄せ（(42-16)/2=13）
     newsSpr.print(lines[i].text);
 
     // バッジ右端（x=BADGE_W）からスプライトを押し出す
+    uint32_t t0 = micros();
     newsSpr.pushSprite(BADGE_W, startY + i * lineH);
+    pushUs += micros() - t0;
 
-    lines[i].x -= SCROLL_PX_PER_TICK;
-    if (lines[i].x < -lines[i].w) lines[i].x = 250;
+    lines[i].x -= stepPx;
+    if (lines[i].x < -lines[i].w) loadNextHeadline(i);
   }
+  gPushUs[SPR_NEWS] = pushUs;
+}
+
+// ===================== ページ静的レイヤー（RLEキャッシュ, UiTaskのみアクセス） =====================
+// 各ページの静的部分を一度だけ描いて圧縮保持し、切替時は1回の転送で復元する
+static const int PAGE_COUNT = 2;
+static RleImage  gPageCache[PAGE_COUNT]; // 0=メイン, 1=センサー
+static uint16_t  gPageLine[320];         // 展開用1行バッファ
+
+static void drawSensorPageStatic(M5Canvas& g); // センサーページ節で定義
+
+// 一時キャンバス(4bit 320x240 = 38.4KB)に描いて圧縮し、すぐ解放
+static bool buildPageCache(int page) {
+  M5Canvas tmp(&M5.Display);
+  if (!createPaletteSprite(tmp, 320, 240)) return false;
+  if (page == 0) drawStaticUI(tmp);
+  else           drawSensorPageStatic(tmp);
+  bool ok = rleEncode(gPageCache[page], 320, 240,
+                      [&](uint16_t x, uint16_t y) { return (uint8_t)tmp.readPixelValue(x, y); });
+  tmp.deleteSprite();
+  return ok;
+}
+
+static void restorePageStatic(int page) {
+  // 起動時に作れなかった場合はここで再試行。それでもダメなら背景だけ
+  if (!gPageCache[page].valid() && !buildPageCache(page)) {
+    M5.Display.fillScreen(BG_TOP);
+    return;
+  }
+  const RleImage& img = gPageCache[page];
+  M5.Display.startWrite();
+  M5.Display.setAddrWindow(0, 0, img.w, img.h);
+  // PALETTE はネイティブ順の RGB565。swap 指定なしの writePixels は uint16 を送信順（バイト入替済み）と
+  // みなすので、明示的に swap = true で渡す
+  rleDecode(img, PALETTE, gPageLine,
+            [&](uint16_t, const uint16_t* line) { M5.Display.writePixels(line, img.w, true); });
+  M5.Display.endWrite();
 }
 
 // ===================== センサーページ =====================
-// 静的部分：ページ切替時に1回だけ呼ぶ
-static void drawSensorPageStatic() {
-  M5.Display.fillScreen(BG_TOP);
+// 静的部分（キャッシュ生成時にキャンバスへ描く）
+static void drawSensorPageStatic(M5Canvas& g) {
+  g.fillSprite(PI_BG_TOP);
 
   // ヘッダー (y=0..23)
-  M5.Display.fillRect(0, 0, 320, 23, BG_PANEL);
-  M5.Display.setTextSize(2);
-  M5.Display.setTextColor(C_ACCENT, BG_PANEL);
-  M5.Display.setCursor(84, 4);
-  M5.Display.print("-- ENV III SENSOR --");
-  M5.Display.drawFastHLine(0, 23, 320, C_ACCENT);
+  g.fillRect(0, 0, 320, 23, PI_BG_PANEL);
+  g.setTextSize(2);
+  g.setTextColor(PI_ACCENT, PI_BG_PANEL);
+  g.setCursor(84, 4);
+  g.print("-- ENV III SENSOR --");
+  g.drawFastHLine(0, 23, 320, PI_ACCENT);
 
   // 温度セクション (y=24..95)
-  M5.Display.fillRect(0, 24, 5, 72, 0xFD20);        // 左バー ORANGE
-  M5.Display.setTextSize(2);
-  M5.Display.setTextColor(C_DIM, BG_TOP);
-  M5.Display.setCursor(14, 30);
-  M5.Display.print("TEMPERATURE");
-  M5.Display.drawFastHLine(5, 95, 315, C_DIM);
+  g.fillRect(0, 24, 5, 72, PI_ORANGE);        // 左バー
+  g.setTextSize(2);
+  g.setTextColor(PI_DIM, PI_BG_TOP);
+  g.setCursor(14, 30);
+  g.print("TEMPERATURE");
+  g.drawFastHLine(5, 95, 315, PI_DIM);
 
   // 湿度セクション (y=96..167)
-  M5.Display.fillRect(0, 96, 320, 72, BG_PANEL);
-  M5.Display.fillRect(0, 96, 5, 72, 0x07E0);        // 左バー GREEN
-  M5.Display.setTextSize(2);
-  M5.Display.setTextColor(C_DIM, BG_PANEL);
-  M5.Display.setCursor(14, 102);
-  M5.Display.print("HUMIDITY");
+  g.fillRect(0, 96, 320, 72, PI_BG_PANEL);
+  g.fillRect(0, 96, 5, 72, PI_GREEN);         // 左バー
+  g.setTextSize(2);
+  g.setTextColor(PI_DIM, PI_BG_PANEL);
+  g.setCursor(14, 102);
+  g.print("HUMIDITY");
   // プログレスバー背景
-  M5.Display.fillRect(14, 153, 294, 8, C_DIM);
-  M5.Display.drawFastHLine(5, 167, 315, C_DIM);
+  g.fillRect(14, 153, 294, 8, PI_DIM);
+  g.drawFastHLine(5, 167, 315, PI_DIM);
 
   // 気圧セクション (y=168..239)
-  M5.Display.fillRect(0, 168, 5, 72, 0xFFE0);       // 左バー YELLOW
-  M5.Display.setTextSize(2);
-  M5.Display.setTextColor(C_DIM, BG_TOP);
-  M5.Display.setCursor(14, 174);
-  M5.Display.print("PRESSURE");
+  g.fillRect(0, 168, 5, 72, PI_YELLOW);       // 左バー
+  g.setTextSize(2);
+  g.setTextColor(PI_DIM, PI_BG_TOP);
+  g.setCursor(14, 174);
+  g.print("PRESSURE");
 
   // フッターヒント
+  g.setTextSize(1);
+  g.setTextColor(PI_DIM, PI_BG_TOP);
+  g.setCursor(190, 228);
+  g.print("[B] Win [C] Clock");
+}
+
+// 統計2行（ラベル右側, size1）。固定幅で上書きするので消去不要
+static void drawStatLines(int y, uint16_t bg, const char* win,
+                          const WindowStats& st, bool ok, const char* fmt) {
+  char l1[32], l2[32];
+  if (ok) {
+    char mn[12], mx[12], av[12];
+    snprintf(mn, sizeof(mn), fmt, st.min);
+    snprintf(mx, sizeof(mx), fmt, st.max);
+    snprintf(av, sizeof(av), fmt, st.mean);
+    snprintf(l1, sizeof(l1), "%-3s min %s max %s", win, mn, mx);
+    snprintf(l2, sizeof(l2), "    avg %s sd %.2f", av, st.sd);
+  } else {
+    snprintf(l1, sizeof(l1), "%-3s (collecting)", win);
+    l2[0] = '\0';
+  }
   M5.Display.setTextSize(1);
-  M5.Display.setTextColor(C_DIM, BG_TOP);
-  M5.Display.setCursor(220, 228);
-  M5.Display.print("[C] Clock/News");
+  M5.Display.setTextColor(C_DIM, bg);
+  M5.Display.setCursor(158, y);
+  M5.Display.printf("%-26s", l1);
+  M5.Display.setCursor(158, y + 10);
+  M5.Display.printf("%-26s", l2);
 }
 
 // 動的部分：値のみ上書き（fillScreen なし → ちらつきゼロ）
 static void drawSensorPage() {
   float temp, humid, pressure;
+  WindowStats stT, stH, stP;
+  bool okT, okH, okP;
+  float dp3h;
+  int win;
   xSemaphoreTake(gMutex, portMAX_DELAY);
   temp = gTemp; humid = gHumid; pressure = gPressure;
+  win = gStatWin;
+  okT = gTempStats.stats((StatWindow)win, stT);
+  okH = gHumidStats.stats((StatWindow)win, stH);
+  okP = gPressStats.stats((StatWindow)win, stP);
+  dp3h = pressureDelta3h(gPressStats);
   xSemaphoreGive(gMutex);
 
+  const char* wl = STAT_WINDOW_LABELS[win];
+  drawStatLines(30,  BG_TOP,   wl, stT, okT, "%.1f");
+  drawStatLines(100, BG_PANEL, wl, stH, okH, "%.1f");
+  drawStatLines(174, BG_TOP,   wl, stP, okP, "%.1f");
+
+  // 派生値：露点・体感温度（温度セクション下部）
+  char dline[40];
+  float dew = dewPointC(temp, humid);
+  float hi  = heatIndexC(temp, humid);
+  if (!isnan(dew) && !isnan(hi)) snprintf(dline, sizeof(dline), "DEW %.1f C   FEELS %.1f C", dew, hi);
+  else                           snprintf(dline, sizeof(dline), "DEW --- C   FEELS --- C");
+  M5.Display.setTextSize(1);
+  M5.Display.setTextColor(C_DIM, BG_TOP);
+  M5.Display.setCursor(14, 85);
+  M5.Display.printf("%-28s", dline);
+
+  // 3時間気圧傾向 → 簡易天気予想（気圧セクション下部）
+  char pline[40];
+  PressureTrend tr = classifyPressureTrend(dp3h);
+  if (tr != PT_UNKNOWN) snprintf(pline, sizeof(pline), "3h %+.1fhPa %s", dp3h, pressureOutlook(tr));
+  else                  snprintf(pline, sizeof(pline), "3h --- %s", pressureOutlook(tr));
+  M5.Display.setCursor(14, 228);
+  M5.Display.printf("%-28s", pline);
+
   // 温度値 (size4=32px高, y=50でセクション内中央)
   M5.Display.setTextSize(4);
   M5.Display.setTextColor(0xFD20, BG_TOP); // ORANGE
@@ -691,7 +1023,287 @@ static void drawSensorPage() {
   else                  M5.Display.print ("   ---  hPa");
 }
 
+// ===================== 共有状態への反映（直接取得 / リレー共通） =====================
+static void applyBtc(double v) {
+  xSemaphoreTake(gMutex, portMAX_DELAY);
+  gBtcPrev = (gBtc > 0.0) ? gBtc : v;
+  gBtc = v;
+  gBtcRev++;
+  if (isTimeValid()) gBtcCandles.add((uint32_t)time(nullptr), v);
+  xSemaphoreGive(gMutex);
+}
+
+static void applyRates(const char* s, size_t n) {
+  if (n >= sizeof(gTicker)) n = sizeof(gTicker) - 1;
+  xSemaphoreTake(gMutex, portMAX_DELAY);
+  memcpy(gTicker, s, n);
+  gTicker[n] = '\0';
+  gTickerRev++;
+  xSemaphoreGive(gMutex);
+}
+
+static void setFeedState(int feed, FeedState st) {
+  xSemaphoreTake(gMutex, portMAX_DELAY);
+  gFeedState[feed] = st;
+  xSemaphoreGive(gMutex);
+}
+
+static void noteFetch(FetchSrc src, bool ok, uint32_t ms) {
+  xSemaphoreTake(gMutex, portMAX_DELAY);
+  gFetchMs[src] = ms;
+  if (ok) gFetchOk[src]++;
+  else    gFetchFail[src]++;
+  gUpstreamReqs++;
+  xSemaphoreGive(gMutex);
+}
+
+// ===================== LANリレー（NetTaskのみアクセス） =====================
+// 送受信の状態遷移は RelayProto.h（RelayServer / RelayClient）。ここはソケットと共有状態への適用だけ
+struct RelayLink {
+  WiFiUDP     udp;
+  bool        started = false;
+  RelayServer srv;
+  RelayClient cli;
+};
+static RelayLink gRelay;
+static uint8_t   gRelayBuf[RELAY_MAX_PACKET];
+
+static void relayBegin(uint32_t now) {
+  if (gRelay.started) return;
+  if (RELAY_ROLE == RELAY_CLIENT) gRelay.udp.beginMulticast(RELAY_GROUP, RELAY_PORT);
+  else                            gRelay.udp.begin(RELAY_PORT);
+  if (RELAY_ROLE == RELAY_SERVER && !gRelay.srv.epoch) gRelay.srv.epoch = esp_random() | 1;
+  gRelay.started = true;
+  gRelay.cli.start(now);
+}
+
+static void relayStop() {
+  if (!gRelay.started) return;
+  gRelay.udp.stop();
+  gRelay.started = false;
+}
+
+// SERVER：送信と、送る値の読み出し（gMutex の中で写す）
+struct RelayServerHost {
+  void relaySend(const uint8_t* p, size_t n) {
+    gRelay.udp.beginPacket(RELAY_GROUP, RELAY_PORT);
+    gRelay.udp.write(p, n);
+    if (gRelay.udp.endPacket()) {
+      xSemaphoreTake(gMutex, portMAX_DELAY);
+      gRelayTx++;
+      xSemaphoreGive(gMutex);
+    }
+  }
+  double relayBtc() {
+    xSemaphoreTake(gMutex, portMAX_DELAY);
+    double v = gBtc;
+    xSemaphoreGive(gMutex);
+    return v;
+  }
+  void relayRates(char* out, size_t cap) {
+    xSemaphoreTake(gMutex, portMAX_DELAY);
+    snprintf(out, cap, "%s", gTicker);
+    xSemaphoreGive(gMutex);
+  }
+  const HeadlineStore& relayNewsLock() { xSemaphoreTake(gMutex, portMAX_DELAY); return gNews; }
+  void relayNewsUnlock() { xSemaphoreGive(gMutex); }
+};
+
+// SERVER：変化した項目だけ送る。定期的に全量を再送して取りこぼしを救済
+static void relayServerPump(uint32_t now) {
+  RelayServerHost h;
+  gRelay.srv.pump(now, gRelayBuf, sizeof(gRelayBuf), h);
+}
+
+// CLIENT：受信した差分を共有状態へ適用する
+struct RelayClientHost {
+  KwTags tags; // キーワードは台ごとの設定なので受信側で照合する
+
+  void relayApplyBtc(double price)               { applyBtc(price); }
+  void relayApplyRates(const char* s, size_t len) { applyRates(s, len); }
+  void relayNewsBegin(int f) {
+    xSemaphoreTake(gMutex, portMAX_DELAY);
+    gNews.beginFeed(f);
+    xSemaphoreGive(gMutex);
+  }
+  void relayNewsTitle(int f, const char* s, uint8_t len) {
+    gWatch.beginText(tags); gWatch.feed(s, len, tags); gWatch.endText(tags);
+    xSemaphoreTake(gMutex, portMAX_DELAY);
+    gNews.add(f, s, len, &tags);
+    xSemaphoreGive(gMutex);
+  }
+  void relayNewsCommit(int f) {
+    xSemaphoreTake(gMutex, portMAX_DELAY);
+    gNews.commitFeed(f);
+    gFeedState[f] = FEED_OK;
+    xSemaphoreGive(gMutex);
+  }
+  void relayNewsAbort(int f) {
+    xSemaphoreTake(gMutex, portMAX_DELAY);
+    gNews.abortFeed(f);
+    xSemaphoreGive(gMutex);
+  }
+  void relayResynced() {
+    xSemaphoreTake(gMutex, portMAX_DELAY);
+    gRelayResyncs++;
+    xSemaphoreGive(gMutex);
+  }
+};
+
+// CLIENT：届いた差分を適用。戻り値 = リレーが生きているか
+static bool relayClientPoll(uint32_t now) {
+  RelayClientHost h;
+  int n;
+  while ((n = gRelay.udp.parsePacket()) > 0) {
+    uint32_t rxAt = millis();
+    int len = gRelay.udp.read(gRelayBuf, sizeof(gRelayBuf));
+    RelayMsg m;
+    if (len <= 0 || !relayDecode(gRelayBuf, (size_t)len, m)) continue;
+    if (gRelay.cli.onPacket(m, rxAt, h)) {
+      xSemaphoreTake(gMutex, portMAX_DELAY);
+      gRelayRx++;
+      gRelayAgeMs = m.ageMs + (millis() - rxAt);
+      xSemaphoreGive(gMutex);
+    }
+  }
+
+  bool live = gRelay.cli.live(now);
+  xSemaphoreTake(gMutex, portMAX_DELAY);
+  gRelayLive = live;
+  xSemaphoreGive(gMutex);
+  return live;
+}
+
+// ===================== ステータスHTTP（HttpTaskのみアクセス） =====================
+static WiFiServer     gHttpServer(HTTP_PORT);
+static StatusSnapshot gSnap; // 約2.1KB。スタックに置かない
+
+// 見出しを1件コピー（HTTP応答中に1件ずつ呼ばれる）。スナップショット後に差し替わっていたら false
+static bool snapHeadline(int feed, uint32_t rev, int index, char* out, size_t outsz) {
+  xSemaphoreTake(gMutex, portMAX_DELAY);
+  bool ok = gNews.rev(feed) == rev && index < gNews.count(feed);
+  if (ok) gNews.copy(feed, index, out, outsz);
+  xSemaphoreGive(gMutex);
+  return ok;
+}
+
+// 共有状態をまとめてコピー（ロックはコピーの間だけ → UiTask を待たせない）
+static void takeSnapshot(StatusSnapshot& s) {
+  xSemaphoreTake(gMutex, portMAX_DELAY);
+  s.btc = gBtc; s.btcPrev = gBtcPrev; s.btcRev = gBtcRev;
+  s.btcChange24h = gBtcCandles.change24hPct();
+  s.candleCloses = gBtcCandles.m1.closes();
+  snprintf(s.ticker, sizeof(s.ticker), "%s", gTicker);
+  for (int f = 0; f < SNAP_FEEDS; f++) {
+    s.newsRev[f]   = gNews.rev(f);
+    s.newsCount[f] = gNews.count(f);
+  }
+  s.newsPoolBytes = gNews.liveBytes();
+  s.newsEntries   = gNews.liveEntries();
+  s.newsWatched   = gNews.taggedEntries();
+  s.temp = gTemp; s.humid = gHumid; s.pressure = gPressure;
+  s.press3h = pressureDelta3h(gPressStats);
+  memcpy(s.fetchMs,   gFetchMs,   sizeof(s.fetchMs));
+  memcpy(s.fetchOk,   gFetchOk,   sizeof(s.fetchOk));
+  memcpy(s.fetchFail, gFetchFail, sizeof(s.fetchFail));
+  s.upstreamReqs  = gUpstreamReqs;
+  s.relayRx       = gRelayRx;
+  s.relayTx       = gRelayTx;
+  s.relayAgeMs    = gRelayAgeMs;
+  s.relayResyncs  = gRelayResyncs;
+  s.relayLive     = gRelayLive;
+  s.clockSkewUs    = gClockSkewUs;
+  s.clockSkewMaxUs = gClockSkewMaxUs;
+  s.clockSkewAvgUs = gClockSkewAvgUs;
+  s.clockSecOnly   = gClockSecOnly;
+  s.clockFull      = gClockFull;
+  s.clockDateUpd   = gClockDateUpd;
+  const uint32_t nowMs = millis();
+  s.powerMode        = gPower.mode();
+  s.powerTransitions = gPower.transitions();
+  s.brightness       = gPower.profile().brightness;
+  for (int m = 0; m < PWR_MODE_COUNT; m++) {
+    s.powerSec[m]   = gPower.stats(m, nowMs).ms / 1000.0;
+    s.powerWakes[m] = gPower.wakesPerSec(m, nowMs);
+    s.powerMwh[m]   = gPower.estimateMwhPerHour(m, nowMs);
+  }
+  xSemaphoreGive(gMutex);
+  s.pushTopUs    = gPushUs[SPR_TOP];
+  s.pushTickerUs = gPushUs[SPR_TICKER];
+  s.pushNewsUs   = gPushUs[SPR_NEWS];
+  s.headline      = snapHeadline;
+  s.newsPoolCap   = HL_POOL_BYTES;
+  s.newsRotateUs  = gNewsRotateUs;
+  s.chartDrawUs   = gChartDrawUs;
+  s.watchKeywords = gWatch.keywords();
+  s.watchStates   = gWatch.states();
+  s.watchTableBytes = gWatch.tableBytes();
+  s.pageRestoreUs = gPageRestoreUs;
+  s.pageSwitchUs  = gPageSwitchUs;
+  s.pageSwitchMaxUs = gPageSwitchMaxUs;
+  s.pageCacheBytes = 0;
+  for (int p = 0; p < PAGE_COUNT; p++) s.pageCacheBytes += gPageCache[p].size;
+
+  s.relayRole = RELAY_ROLE;
+  s.uptimeMs  = millis();
+  s.heapFree  = ESP.getFreeHeap();
+  s.heapMin   = ESP.getMinFreeHeap();
+  s.wifiOk    = (WiFi.status() == WL_CONNECTED);
+  s.rssi      = s.wifiOk ? WiFi.RSSI() : 0;
+}
+
+// 1行読む（CRLF除去）。タイムアウトか切断で false
+static bool readHttpLine(WiFiClient& c, char* dst, size_t dstsz, uint32_t deadline) {
+  size_t n = 0;
+  while (c.connected() && (int32_t)(deadline - millis()) > 0) {
+    int ch = c.read();
+    if (ch < 0) { vTaskDelay(pdMS_TO_TICKS(2)); continue; }
+    if (ch == '\n') { dst[n] = '\0'; return true; }
+    if (ch != '\r' && n + 1 < dstsz) dst[n++] = (char)ch;
+  }
+  return false;
+}
+
+static void HttpTask(void* arg){
+  (void)arg;
+  bool started = false;
+
+  for(;;){
+    gHttpWakes++;
+    if (WiFi.status() != WL_CONNECTED) {
+      vTaskDelay(pdMS_TO_TICKS(500));
+      continue;
+    }
+    if (!started) { gHttpServer.begin(); started = true; }
+
+    WiFiClient c = gHttpServer.available();
+    if (!c) { vTaskDelay(pdMS_TO_TICKS(gPowerNetLoopMs)); continue; }
+
+    uint32_t deadline = millis() + HTTP_READ_TO_MS;
+    char line[128], path[48];
+    bool ok = readHttpLine(c, line, sizeof(line), deadline) &&
+              httpParseGetPath(line, path, sizeof(path));
+    // 残りのヘッダは空行まで読み捨て
+    char hdr[128];
+    while (ok && readHttpLine(c, hdr, sizeof(hdr), deadline) && hdr[0]) {}
+
+    if (ok) {
+      takeSnapshot(gSnap);
+      serveStatusRequest(c, path, gSnap);
+    }
+    c.stop();
+  }
+}
+
 // ===================== タスク =====================
+// モデムスリープ切替（NetTaskのみ）。同じ値での WiFi.setSleep 呼び出しは避ける
+static bool gWifiSleeping = false;
+static void netSetSleep(bool on) {
+  if (on == gWifiSleeping) return;
+  WiFi.setSleep(on);
+  gWifiSleeping = on;
+}
+
 static void NetTask(void* arg){
   (void)arg;
   WiFi.mode(WIFI_STA);
@@ -708,8 +1320,10 @@ static void NetTask(void* arg){
 
   for(;;){
     uint32_t now = millis();
+    gNetWakes++;
 
     if (WiFi.status() != WL_CONNECTED) {
+      relayStop(); // 再接続後にマルチキャスト参加をやり直す
       if (now - wifiStart > WIFI_TIMEOUT_MS && now - wifiStart > 10000) {
         WiFi.disconnect(true, true);
         WiFi.begin(WIFI_SSID, WIFI_PASS);
@@ -730,83 +1344,167 @@ static void NetTask(void* arg){
     }
     if (isTimeValid()) ntpStarted = false;
 
+    // LANリレー：CLIENT は受信中なら直接取得しない
+    bool fetchDirect = true;
+    if (RELAY_ROLE != RELAY_OFF) {
+      relayBegin(now);
+      if (RELAY_ROLE == RELAY_CLIENT) fetchDirect = !relayClientPoll(now);
+    }
+
+    // 省電力モード中は取得と取得の間だけモデムスリープ（取得する周回は起こしておく）。
+    // CLIENT はマルチキャストの取りこぼしを避けるため常に起こしておく
+    bool fetchDue = fetchDirect && (now - lastBtc   >= BTC_UPDATE_MS ||
+                                    now - lastRss   >= RSS_UPDATE_MS ||
+                                    now - lastRates >= RATES_UPDATE_MS);
+    netSetSleep(gPowerModemSleep && RELAY_ROLE != RELAY_CLIENT && !fetchDue);
+
     // BTC
-    if (now - lastBtc >= BTC_UPDATE_MS) {
+    if (fetchDirect && now - lastBtc >= BTC_UPDATE_MS) {
       double v;
-      if (fetchBtc(v)) {
-        xSemaphoreTake(gMutex, portMAX_DELAY);
-        gBtcPrev = (gBtc > 0.0) ? gBtc : v;
-        gBtc = v;
-        gBtcRev++;
-        xSemaphoreGive(gMutex);
+      uint32_t t0 = millis();
+      bool ok = fetchBtc(v);
+      noteFetch(SRC_BTC, ok, millis() - t0);
+      if (ok) {
+        applyBtc(v);
+        if (RELAY_ROLE == RELAY_SERVER) gRelay.srv.noteBtc(millis());
       }
       lastBtc = now;
     }
 
     // RSS（BBC 3本）
-    if (now - lastRss >= RSS_UPDATE_MS) {
-      char buf[RSS_BUF_SZ];
-
-      bool okW = fetchRssTitlesStreamToBuf(RSS_WORLD_URL, buf, sizeof(buf), 4);
-      xSemaphoreTake(gMutex, portMAX_DELAY);
-      snprintf(gWorld, sizeof(gWorld), "%s", okW ? buf : "(WORLD failed)");
-      xSemaphoreGive(gMutex);
-
-      bool okB = fetchRssTitlesStreamToBuf(RSS_BUSINESS_URL, buf, sizeof(buf), 4);
-      xSemaphoreTake(gMutex, portMAX_DELAY);
-      snprintf(gBusiness, sizeof(gBusiness), "%s", okB ? buf : "(BUSINESS failed)");
-      xSemaphoreGive(gMutex);
-
-      bool okT = fetchRssTitlesStreamToBuf(RSS_TECH_URL, buf, sizeof(buf), 4);
-      xSemaphoreTake(gMutex, portMAX_DELAY);
-      snprintf(gTech, sizeof(gTech), "%s", okT ? buf : "(TECH failed)");
-      gRssRev++;
-      xSemaphoreGive(gMutex);
+    if (fetchDirect && now - lastRss >= RSS_UPDATE_MS) {
+      static const char* URLS[HL_FEEDS] = {RSS_WORLD_URL, RSS_BUSINESS_URL, RSS_TECH_URL};
+
+      for (int i = 0; i < HL_FEEDS; i++) {
+        uint32_t t0 = millis();
+        bool ok = fetchRssTitlesStream(URLS[i], i);
+        noteFetch((FetchSrc)(SRC_RSS_WORLD + i), ok, millis() - t0);
+        setFeedState(i, ok ? FEED_OK : FEED_FAILED); // 失敗しても旧見出しは表示を続ける
+        if (ok && RELAY_ROLE == RELAY_SERVER) gRelay.srv.noteNews(i, millis());
+      }
 
       lastRss = now;
     }
 
     // 為替レート（5分ごと）
-    if (now - lastRates >= RATES_UPDATE_MS) {
+    if (fetchDirect && now - lastRates >= RATES_UPDATE_MS) {
       char buf[512];
-      if (fetchRates(buf, sizeof(buf))) {
-        xSemaphoreTake(gMutex, portMAX_DELAY);
-        snprintf(gTicker, sizeof(gTicker), "%s", buf);
-        gTickerRev++;
-        xSemaphoreGive(gMutex);
+      uint32_t t0 = millis();
+      bool ok = fetchRates(buf, sizeof(buf));
+      noteFetch(SRC_RATES, ok, millis() - t0);
+      if (ok) {
+        applyRates(buf, strlen(buf));
+        if (RELAY_ROLE == RELAY_SERVER) gRelay.srv.noteRates(millis());
       }
       lastRates = now;
     }
 
-    vTaskDelay(pdMS_TO_TICKS(20));
+    if (RELAY_ROLE == RELAY_SERVER) relayServerPump(millis());
+
+    vTaskDelay(pdMS_TO_TICKS(gPowerNetLoopMs));
+  }
+}
+
+// ENV III の読み取り（Core0・低優先度）。SHT3X の単発測定は変換待ちで十数ms止まるため、
+// UiTask（スクロール・秒の再描画）から外し、値の受け渡しと統計の追加だけ gMutex の中で行う。
+// 統計を途切れさせないためページに関係なく継続
+static void SensorTask(void* arg){
+  (void)arg;
+  TickType_t last = xTaskGetTickCount();
+  for(;;){
+    gSensorWakes++;
+    float t = NAN, h = NAN, p = NAN;
+    if (gSht3x.update())   { t = gSht3x.cTemp;  h = gSht3x.humidity; }
+    if (gQmp6988.update()) { p = gQmp6988.pressure / 100.0f; }
+    uint32_t now = millis();
+    xSemaphoreTake(gMutex, portMAX_DELAY);
+    gTemp = t; gHumid = h; gPressure = p;
+    gTempStats.add(now, t);
+    gHumidStats.add(now, h);
+    gPressStats.add(now, p);
+    xSemaphoreGive(gMutex);
+    vTaskDelayUntil(&last, pdMS_TO_TICKS(SENSOR_UPDATE_MS));
   }
 }
 
 static void UiTask(void* arg){
   (void)arg;
 
-  // スプライト生成
-  topSpr.createSprite(320, TOP_H);    // 320x72 上段
-  tickerSpr.createSprite(320, TICKER_H); // 320x20 通貨ティッカー
-  newsSpr.createSprite(250, 37);      // 250x37 ニュース1段
+  // ページキャッシュ → スプライトの順に確保（一時キャンバスを先に解放して断片化を避ける）
+  for (int p = 0; p < PAGE_COUNT; p++) buildPageCache(p);
 
-  drawStaticUI();
+  // スプライト生成
+  createPaletteSprite(topSpr,    320, TOP_H);    // 320x72 上段
+  createPaletteSprite(tickerSpr, 320, TICKER_H); // 320x20 通貨ティッカー
+  createPaletteSprite(newsSpr,   250, 37);       // 250x37 ニュース1段
+  for (int i = 0; i < 4; i++) loadNextHeadline(i);
 
-  uint32_t lastTop        = 0;
+  time_t   lastTopSec     = -1; // 最後に描画した秒
   uint32_t lastNews       = 0;
-  uint32_t lastSensor     = 0;
   uint32_t lastSensorDraw = 0;
   int      curPage        = -1; // 強制再描画トリガー
+  uint32_t switchAtUs     = 0;  // ページ切替の押下時刻（0=計測なし）
+
+  // 省電力
+  xSemaphoreTake(gMutex, portMAX_DELAY);
+  gPower.cfg.idleAfterMs = OKI_POWER_IDLE_MS;
+  gPower.begin(millis());
+  PowerProfile prof = gPower.profile();
+  xSemaphoreGive(gMutex);
+  uint32_t busyUs     = 0;  // 前回周回の稼働時間
+  uint32_t seenNet    = 0, seenHttp = 0, seenSens = 0;
+  int      hour       = -1; // 夜間判定用（10秒ごとに更新）
+  uint32_t lastHourAt = 0;
 
   for(;;){
     uint32_t now = millis();
+    uint32_t loopT0 = micros();
 
-    // ボタンC: ページ切替
+    // ボタンC: ページ切替 / ボタンB: 統計ウィンドウ切替（センサーページ）/ ボタンA: チャートの足切替（メインページ）
     M5.update();
-    if (M5.BtnC.wasPressed()) {
+    bool btnA = M5.BtnA.wasPressed(), btnB = M5.BtnB.wasPressed(), btnC = M5.BtnC.wasPressed();
+
+    // 省電力モード判定。減光中の押下は復帰だけに使う
+    if (lastHourAt == 0 || now - lastHourAt >= 10000) {
+      hour = -1;
+      if (isTimeValid()) {
+        time_t t = time(nullptr);
+        struct tm lt;
+        localtime_r(&t, &lt);
+        hour = lt.tm_hour;
+      }
+      lastHourAt = now | 1;
+    }
+    uint32_t net = gNetWakes, http = gHttpWakes, sens = gSensorWakes;
+    xSemaphoreTake(gMutex, portMAX_DELAY);
+    bool woke = (btnA || btnB || btnC) && gPower.onInput(now);
+    bool modeChanged = gPower.update(now, hour) || woke;
+    gPower.noteWakes(1 + (net - seenNet) + (http - seenHttp) + (sens - seenSens), busyUs);
+    if (modeChanged) prof = gPower.profile();
+    xSemaphoreGive(gMutex);
+    seenNet = net; seenHttp = http; seenSens = sens;
+    if (modeChanged) {
+      M5.Display.setBrightness(prof.brightness);
+      gPowerModemSleep = prof.modemSleep;
+      gPowerNetLoopMs  = prof.netLoopMs;
+    }
+    if (woke) btnA = btnB = btnC = false;
+
+    if (btnC) {
       xSemaphoreTake(gMutex, portMAX_DELAY);
       gPage = 1 - gPage;
       xSemaphoreGive(gMutex);
+      switchAtUs = micros() | 1;
+    }
+    if (btnB && curPage == 1) {
+      xSemaphoreTake(gMutex, portMAX_DELAY);
+      gStatWin = (gStatWin + 1) % WIN_COUNT;
+      xSemaphoreGive(gMutex);
+      lastSensorDraw = 0; // 即時更新
+    }
+    if (btnA && curPage == 0) {
+      gChartTf   = (gChartTf + 1) % TF_COUNT;
+      lastTopSec = -1; // 即時更新
     }
 
     // 現在ページ取得
@@ -815,50 +1513,81 @@ static void UiTask(void* arg){
     page = gPage;
     xSemaphoreGive(gMutex);
 
-    // ページ切替時に静的部分を一度だけ描画
+    // ページ切替：静的部分はキャッシュから1回で復元、動的部分は保持している状態から即描画
     if (page != curPage) {
       curPage = page;
+      uint32_t t0 = micros();
+      restorePageStatic(page);
+      gPageRestoreUs = micros() - t0;
       if (page == 0) {
-        drawStaticUI();
-        lastTop = 0; lastNews = 0; // 即時更新
+        lastTopSec = -1; lastNews = 0; // 即時更新
       } else {
-        drawSensorPageStatic(); // fillScreen はここだけ
-        lastSensorDraw = 0;     // 即時更新
+        lastSensorDraw = 0;            // 即時更新
       }
     }
 
     if (page == 0) {
       // ── メインページ ──
-      if (now - lastTop >= TOP_UI_MS) {
+      // 上段：秒の切り替わりに合わせて再描画（時計の文字列は差分更新）
+      bool synced;
+      uint32_t usInto;
+      time_t sec = displaySecond(synced, usInto);
+      if (sec != lastTopSec) {
+        if (synced) gClock.setTime(sec);
+        else        gClock.setUptime((uint32_t)sec);
+        bool forced = (lastTopSec == -1);
         drawTopDynamic();
-        lastTop = now;
+        lastTopSec = sec;
+
+        // 表示ずれ計測：秒の境界から転送完了まで（ページ切替直後は除外）
+        time_t sec2 = displaySecond(synced, usInto);
+        uint32_t skew = (uint32_t)(sec2 - sec) * 1000000UL + usInto;
+        xSemaphoreTake(gMutex, portMAX_DELAY);
+        if (!forced && sec2 >= sec) {
+          gClockSkewUs = skew;
+          if (skew > gClockSkewMaxUs) gClockSkewMaxUs = skew;
+          gClockSkewAvgUs = gClockSkewAvgUs - gClockSkewAvgUs / 16 + skew / 16;
+        }
+        gClockSecOnly = gClock.secOnly; gClockFull = gClock.full; gClockDateUpd = gClock.dateUpdates;
+        xSemaphoreGive(gMutex);
       }
-      if (now - lastNews >= NEWS_TICK_MS) {
-        rebuild4LinesIfNeeded();
-        drawTicker();
-        drawNews4Lines();
+      if (prof.frameMs && now - lastNews >= prof.frameMs) { // NIGHT はスクロール停止
+        drawTicker(scrollStep(TICKER_PX_PER_TICK, prof.frameMs));
+        drawNews4Lines(scrollStep(SCROLL_PX_PER_TICK, prof.frameMs));
         lastNews = now;
       }
     } else {
       // ── センサーページ ──
-      // センサー読み取り
-      if (now - lastSensor >= SENSOR_UPDATE_MS) {
-        float t = NAN, h = NAN, p = NAN;
-        if (gSht3x.update())   { t = gSht3x.cTemp;  h = gSht3x.humidity; }
-        if (gQmp6988.update()) { p = gQmp6988.pressure / 100.0f; }
-        xSemaphoreTake(gMutex, portMAX_DELAY);
-        gTemp = t; gHumid = h; gPressure = p;
-        xSemaphoreGive(gMutex);
-        lastSensor = now;
-      }
-      // センサー描画（500ms毎）
-      if (now - lastSensorDraw >= 500) {
+      // センサー描画（ACTIVE は500ms毎、省電力中は間引く）
+      if (now - lastSensorDraw >= prof.sensorMs) {
         drawSensorPage();
         lastSensorDraw = now;
       }
     }
 
-    vTaskDelay(pdMS_TO_TICKS(1));
+    // ページ切替の体感レイテンシ：押下 → 静的復元 + 動的部分の初回描画まで
+    if (switchAtUs && page == curPage) {
+      gPageSwitchUs = micros() - switchAtUs;
+      if (gPageSwitchUs > gPageSwitchMaxUs) gPageSwitchMaxUs = gPageSwitchUs;
+      switchAtUs = 0;
+      Serial.printf("page %d: restore %lu us, press to drawn %lu us\n", page,
+                    (unsigned long)gPageRestoreUs, (unsigned long)gPageSwitchUs);
+    }
+
+    // 次の締め切り（秒の切り替わり / 次のコマ / センサー描画）まで眠る。上限 pollMs がボタン応答の最悪値
+    uint32_t t    = millis();
+    uint32_t wait = prof.pollMs;
+    if (page == 0) {
+      bool synced;
+      uint32_t usInto;
+      displaySecond(synced, usInto);
+      wait = minU32(wait, (1000000UL - usInto) / 1000 + 1);
+      if (prof.frameMs) wait = minU32(wait, untilDue(lastNews, prof.frameMs, t));
+    } else {
+      wait = minU32(wait, untilDue(lastSensorDraw, prof.sensorMs, t));
+    }
+    busyUs = micros() - loopT0;
+    vTaskDelay(pdMS_TO_TICKS(wait ? wait : 1));
   }
 }
 
@@ -874,22 +1603,19 @@ void setup(){
 
   gMutex = xSemaphoreCreateMutex();
 
+  // 注目キーワードのDFA（タスク起動前に1回だけ）
+  if (!gWatch.build(WATCH_KEYWORDS, WATCH_KEYWORD_COUNT)) Serial.println("watchlist build failed");
+
   // ENV III センサー初期化
   Wire.begin(21, 22);
   gSht3x.begin(&Wire,   0x44, 21, 22, 400000UL);
   gQmp6988.begin(&Wire, 0x70, 21, 22, 400000UL);
 
-  // 初期値
-  xSemaphoreTake(gMutex, portMAX_DELAY);
-  snprintf(gWorld, sizeof(gWorld), "%s", "(fetching...)");
-  snprintf(gBusiness, sizeof(gBusiness), "%s", "(fetching...)");
-  snprintf(gTech, sizeof(gTech), "%s", "(fetching...)");
-  gRssRev++;
-  xSemaphoreGive(gMutex);
-
-  // UI=Core1、NET=Core0
+  // UI=Core1、NET / HTTP / センサー=Core0
   xTaskCreatePinnedToCore(UiTask,  "UiTask",  8192, nullptr, 2, nullptr, 1);
   xTaskCreatePinnedToCore(NetTask, "NetTask", 8192, nullptr, 1, nullptr, 0);
+  xTaskCreatePinnedToCore(HttpTask, "HttpTask", 4096, nullptr, 1, nullptr, 0);
+  xTaskCreatePinnedToCore(SensorTask, "SensorTask", 3072, nullptr, 1, nullptr, 0);
 
   for(;;) delay(1000);
 }
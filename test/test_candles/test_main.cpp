@@ -0,0 +1,174 @@
+// Candles.h のホストテスト（pio test -e native -f test_candles）
+//   - 足ごとに std::map へ集計する素朴な参照実装と、欠損・時刻の逆行を含む 4万更新で全足を突き合わせる
+//   - 欠損の穴埋めがリング長で打ち切られること、時刻が戻っても進行中の足に入ること
+//   - rev は OHLC が変わった時だけ進むこと、24h変化率は 15分足が1日分たまるまで NaN であること
+#include <unity.h>
+#include <stdio.h>
+#include <math.h>
+#include <string.h>
+#include <map>
+#include <random>
+#include "Candles.h"
+
+void setUp() {}
+void tearDown() {}
+
+// 参照実装：足の番号 → OHLC。空いた足は直前の終値で全部埋める（打ち切りなし）
+struct RefSeries {
+  uint32_t period;
+  std::map<uint32_t, Candle> m;
+  uint32_t cur = 0;
+  uint32_t closes = 0;
+  uint32_t rev = 0;
+
+  explicit RefSeries(uint32_t p) : period(p) {}
+
+  void add(uint32_t t, float p) {
+    uint32_t b = t / period;
+    if (m.empty()) { cur = b; m[b] = Candle{p, p, p, p}; rev++; return; }
+    if (b <= cur) {
+      Candle& k = m[cur];
+      Candle before = k;
+      k.c = p;
+      k.h = fmaxf(k.h, p);
+      k.l = fminf(k.l, p);
+      if (memcmp(&before, &k, sizeof k) != 0) rev++;
+      return;
+    }
+    const float last = m[cur].c;
+    for (uint32_t x = cur + 1; x < b; x++) m[x] = Candle{last, last, last, last};
+    m[b] = Candle{p, p, p, p};
+    cur = b;
+    closes++;
+    rev++;
+  }
+};
+
+template <uint32_t P, int N>
+static void expectSame(const CandleSeries<P, N>& s, const RefSeries& r, uint32_t step) {
+  char msg[120];
+  snprintf(msg, sizeof msg, "period %u, update %u", (unsigned)P, (unsigned)step);
+  int want = r.m.size() < (size_t)N ? (int)r.m.size() : N;
+  TEST_ASSERT_EQUAL_INT_MESSAGE(want, s.count(), msg);
+  TEST_ASSERT_EQUAL_UINT32_MESSAGE(r.rev, s.rev(), msg);
+  TEST_ASSERT_EQUAL_UINT32_MESSAGE(r.closes, s.closes(), msg);
+  std::map<uint32_t, Candle>::const_reverse_iterator it = r.m.rbegin();
+  for (int i = s.count() - 1; i >= 0; i--, ++it) {
+    const Candle& a = s.at(i);
+    const Candle& e = it->second;
+    TEST_ASSERT_TRUE_MESSAGE(a.o == e.o && a.h == e.h && a.l == e.l && a.c == e.c, msg);
+  }
+}
+
+// 数秒おきの更新に、数分〜数日の欠損・数秒〜数分の逆行・同値の連続を混ぜる
+static void test_matches_reference_aggregator() {
+  BtcCandles cs;
+  RefSeries r1(60), r15(900), rh(3600);
+  std::mt19937 rng(7);
+  uint32_t t = 1700000000u;
+  float p = 16000000.0f;
+  int gaps = 0, backs = 0, longGaps = 0;
+  for (uint32_t i = 0; i < 40000; i++) {
+    uint32_t k = rng() % 1000;
+    if (k < 5)       { t += 3600 * (1 + rng() % 72); gaps++; longGaps++; } // 48時間超は 1時間足でも打ち切り
+    else if (k < 25) { t += 60 + rng() % 1800; gaps++; }
+    else if (k < 40) { t -= 1 + rng() % 180; backs++; }
+    else             t += 1 + rng() % 20;
+    if (rng() % 4) p += (float)((int)(rng() % 2001) - 1000);
+
+    cs.add(t, p);
+    r1.add(t, p); r15.add(t, p); rh.add(t, p);
+    expectSame(cs.m1, r1, i);
+    expectSame(cs.m15, r15, i);
+    expectSame(cs.h1, rh, i);
+  }
+  char msg[120];
+  snprintf(msg, sizeof msg, "%d gaps (%d of 1h+), %d backward steps; 15m closes %u, rev %u",
+           gaps, longGaps, backs, (unsigned)cs.m15.closes(), (unsigned)cs.m15.rev());
+  TEST_MESSAGE(msg);
+  TEST_ASSERT_GREATER_THAN(100, backs);
+  TEST_ASSERT_GREATER_THAN(100, gaps);
+}
+
+static void test_gap_fill_capped_at_ring_length() {
+  CandleSeries<60, 8> s;
+  s.add(600, 100.0f);
+  s.add(659, 120.0f);
+  TEST_ASSERT_EQUAL_INT(1, s.count());
+  s.add(60u * 3, 130.0f); // 時刻が戻った → 進行中の足へ
+  TEST_ASSERT_EQUAL_INT(1, s.count());
+  TEST_ASSERT_EQUAL_FLOAT(130.0f, s.live().c);
+  TEST_ASSERT_EQUAL_FLOAT(130.0f, s.live().h);
+
+  // 3本空けて次の足 → 平らな足3本 + 新しい足
+  s.add(60u * 14, 90.0f);
+  TEST_ASSERT_EQUAL_INT(5, s.count());
+  TEST_ASSERT_EQUAL_UINT32(1, s.closes());
+  for (int i = 1; i <= 3; i++) {
+    const Candle& k = s.at(i);
+    TEST_ASSERT_TRUE(k.o == 130.0f && k.h == 130.0f && k.l == 130.0f && k.c == 130.0f);
+  }
+  TEST_ASSERT_EQUAL_FLOAT(90.0f, s.at(4).o);
+
+  // 約136年分の欠損でもリング長で打ち切り（戻ってくれば即座に終わる）
+  s.add(0xFFFFFFF0u, 50.0f);
+  TEST_ASSERT_EQUAL_INT(8, s.count());
+  TEST_ASSERT_EQUAL_UINT32(2, s.closes());
+  for (int i = 0; i < 7; i++) TEST_ASSERT_EQUAL_FLOAT(90.0f, s.at(i).c);
+  TEST_ASSERT_EQUAL_FLOAT(50.0f, s.live().o);
+
+  // 大きく戻った時刻は進行中の足に入る（足を巻き戻さない）
+  TEST_ASSERT_TRUE(s.add(60u * 20, 40.0f));
+  TEST_ASSERT_EQUAL_INT(8, s.count());
+  TEST_ASSERT_EQUAL_UINT32(2, s.closes());
+  TEST_ASSERT_EQUAL_FLOAT(40.0f, s.live().l);
+  TEST_ASSERT_EQUAL_FLOAT(50.0f, s.live().o);
+}
+
+static void test_rev_advances_only_on_change() {
+  CandleSeries<60, 4> s;
+  TEST_ASSERT_TRUE(s.add(0, 100.0f));
+  uint32_t r = s.rev();
+  TEST_ASSERT_FALSE(s.add(10, 100.0f)); // 同値
+  TEST_ASSERT_EQUAL_UINT32(r, s.rev());
+  TEST_ASSERT_TRUE(s.add(20, 110.0f));  // 高値更新
+  TEST_ASSERT_TRUE(s.add(30, 100.0f));  // 終値だけ変化（h/l は不変でも OHLC は変わる）
+  TEST_ASSERT_EQUAL_UINT32(r + 2, s.rev());
+  TEST_ASSERT_FALSE(s.add(40, 100.0f));
+  TEST_ASSERT_TRUE(s.add(60, 100.0f));  // 同値でも足の確定は rev を進める
+  TEST_ASSERT_EQUAL_UINT32(r + 3, s.rev());
+  TEST_ASSERT_FALSE(s.add(5, 100.0f));  // 逆行しても変化がなければ進まない
+  TEST_ASSERT_EQUAL_UINT32(r + 3, s.rev());
+}
+
+static void test_change24h_nan_until_full() {
+  BtcCandles cs;
+  TEST_ASSERT_FLOAT_IS_NAN(cs.change24hPct());
+  const uint32_t t0 = 1700000100u; // 15分境界の途中から
+  float p = 1000.0f;
+  uint32_t t = t0;
+  for (; cs.m15.count() < cs.m15.CAP; t += 60) {
+    TEST_ASSERT_FLOAT_IS_NAN(cs.change24hPct());
+    cs.add(t, p);
+    p += 1.0f;
+  }
+  float ch = cs.change24hPct();
+  TEST_ASSERT_FALSE(isnan(ch));
+  const float o = cs.m15.at(0).o;
+  TEST_ASSERT_EQUAL_FLOAT((cs.m15.live().c - o) / o * 100.0f, ch);
+  TEST_ASSERT_GREATER_THAN(0.0f, ch);
+
+  // 満杯になった後は欠損で平らな足が入っても NaN には戻らない
+  cs.add(t + 3600 * 30, p - 1.0f); // 直前の終値のまま
+  TEST_ASSERT_FALSE(isnan(cs.change24hPct()));
+  TEST_ASSERT_EQUAL_FLOAT(0.0f, cs.change24hPct());
+}
+
+int main(int, char**) {
+  UNITY_BEGIN();
+  RUN_TEST(test_matches_reference_aggregator);
+  RUN_TEST(test_gap_fill_capped_at_ring_length);
+  RUN_TEST(test_rev_advances_only_on_change);
+  RUN_TEST(test_change24h_nan_until_full);
+  return UNITY_END();
+}
@@ -0,0 +1,136 @@
+// ClockFormat.h のホストテスト（pio test -e native -f test_clock_format）
+//   - 1秒ずつ / 飛び / 巻き戻しで ClockText を進め、毎回 strftime の結果と突き合わせる
+//   - 秒だけの書き換え / HH:MM:SS の整形 / 日付の整形 の回数を確かめる
+// 実機と同じ JST（TZ=JST-9）で動かす。
+#include <unity.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+#include "ClockFormat.h"
+
+void setUp() {}
+void tearDown() {}
+
+// JST の日時 → time_t
+static time_t jst(int y, int mo, int d, int h, int mi, int s) {
+  struct tm t = {};
+  t.tm_year = y - 1900; t.tm_mon = mo - 1; t.tm_mday = d;
+  t.tm_hour = h; t.tm_min = mi; t.tm_sec = s;
+  t.tm_isdst = 0;
+  return mktime(&t);
+}
+
+static void expectMatches(const ClockText& c, time_t t) {
+  struct tm n;
+  localtime_r(&t, &n);
+  char hms[9], ymd[11], msg[64];
+  strftime(hms, sizeof hms, "%H:%M:%S", &n);
+  strftime(ymd, sizeof ymd, "%Y/%m/%d", &n);
+  snprintf(msg, sizeof msg, "t=%ld (%s %s)", (long)t, ymd, hms);
+  TEST_ASSERT_EQUAL_STRING_MESSAGE(hms, c.hms, msg);
+  TEST_ASSERT_EQUAL_STRING_MESSAGE(ymd, c.ymd, msg);
+  TEST_ASSERT_TRUE_MESSAGE(c.valid, msg);
+}
+
+// 1秒ずつ n 回進め、毎回照合する
+static void stepSeconds(ClockText& c, time_t from, int n) {
+  for (int i = 0; i < n; i++) {
+    c.setTime(from + i);
+    expectMatches(c, from + i);
+  }
+}
+
+// 丸1日：整形は最初の1回と分の切り替わり（1439回）だけ、残りは秒の2桁だけ
+static void test_one_day_counts() {
+  ClockText c;
+  const time_t t0 = jst(2026, 3, 14, 0, 0, 0);
+  stepSeconds(c, t0, 86400);
+  TEST_ASSERT_EQUAL_UINT32(1 + 1439, c.full);
+  TEST_ASSERT_EQUAL_UINT32(86400 - 1440, c.secOnly);
+  TEST_ASSERT_EQUAL_UINT32(1, c.dateUpdates);
+
+  c.setTime(t0 + 86400); // 翌日 0:00:00
+  expectMatches(c, t0 + 86400);
+  TEST_ASSERT_EQUAL_UINT32(2, c.dateUpdates);
+
+  char msg[80];
+  snprintf(msg, sizeof msg, "1 day: %.1f%% seconds-only updates, %u full, %u date",
+           100.0 * c.secOnly / (c.secOnly + c.full), (unsigned)c.full, (unsigned)c.dateUpdates);
+  TEST_MESSAGE(msg);
+}
+
+// 年・月・閏日の切り替わり
+static void test_year_and_month_boundaries() {
+  ClockText c;
+  stepSeconds(c, jst(2026, 12, 31, 23, 58, 30), 180);
+  TEST_ASSERT_EQUAL_UINT32(2, c.dateUpdates);
+  TEST_ASSERT_EQUAL_STRING("2027/01/01", c.ymd);
+
+  ClockText d;
+  stepSeconds(d, jst(2028, 2, 28, 23, 59, 50), 20);   // 閏年
+  stepSeconds(d, jst(2028, 2, 29, 23, 59, 50), 20);
+  TEST_ASSERT_EQUAL_STRING("2028/03/01", d.ymd);
+  TEST_ASSERT_EQUAL_UINT32(3, d.dateUpdates);
+}
+
+// 巻き戻し・飛び・同じ秒の再設定は全部整形し直す（秒だけの書き換えは +1 秒のときだけ）
+static void test_jumps_and_backwards() {
+  ClockText c;
+  const time_t t0 = jst(2026, 7, 1, 12, 30, 10);
+  stepSeconds(c, t0, 5);
+  uint32_t full = c.full, date = c.dateUpdates;
+
+  const time_t steps[] = {
+    t0 + 4,            // 同じ秒
+    t0 + 2,            // 2秒戻る
+    t0 + 3,            // 戻った先から +1 秒（秒だけ）
+    t0 - 3600,         // 1時間戻る
+    t0 - 86400,        // 前日（日付も整形）
+    t0 + 86400 * 400,  // 1年以上先
+    t0 + 86400 * 400 + 2,
+  };
+  const bool secOnly[] = {false, false, true, false, false, false, false};
+  const bool newDate[] = {false, false, false, false, true, true, false};
+  for (size_t i = 0; i < sizeof(steps) / sizeof(steps[0]); i++) {
+    uint32_t so = c.secOnly;
+    c.setTime(steps[i]);
+    expectMatches(c, steps[i]);
+    TEST_ASSERT_EQUAL_UINT32(so + (secOnly[i] ? 1 : 0), c.secOnly);
+    if (!secOnly[i]) full++;
+    if (newDate[i])  date++;
+    TEST_ASSERT_EQUAL_UINT32(full, c.full);
+    TEST_ASSERT_EQUAL_UINT32(date, c.dateUpdates);
+  }
+}
+
+// 未同期（起動からの経過表示）から同期したら日付も必ず整形する
+static void test_uptime_then_sync() {
+  ClockText c;
+  c.setUptime(3 * 3600 + 25 * 60 + 7);
+  TEST_ASSERT_FALSE(c.valid);
+  TEST_ASSERT_EQUAL_STRING("03:25:07", c.hms);
+  TEST_ASSERT_EQUAL_STRING("----/--/--", c.ymd);
+
+  const time_t t = jst(2026, 10, 18, 9, 0, 0);
+  c.setTime(t);
+  expectMatches(c, t);
+  TEST_ASSERT_EQUAL_UINT32(1, c.dateUpdates);
+
+  c.setUptime(10);        // 同期が外れた
+  c.setTime(t + 1);       // 戻ってきたら +1 秒でも整形し直す
+  expectMatches(c, t + 1);
+  TEST_ASSERT_EQUAL_UINT32(0, c.secOnly);
+  TEST_ASSERT_EQUAL_UINT32(2, c.full);
+  TEST_ASSERT_EQUAL_UINT32(2, c.dateUpdates);
+}
+
+int main(int, char**) {
+  setenv("TZ", "JST-9", 1);
+  tzset();
+  UNITY_BEGIN();
+  RUN_TEST(test_one_day_counts);
+  RUN_TEST(test_year_and_month_boundaries);
+  RUN_TEST(test_jumps_and_backwards);
+  RUN_TEST(test_uptime_then_sync);
+  return UNITY_END();
+}
@@ -0,0 +1,223 @@
+// HeadlineStore.h のホストテスト（pio test -e native -f test_headline_store）
+//   - 重複排除（フィード内・フィード間・取得の前後）と照合結果の共有
+//   - beginFeed / add / commitFeed / abortFeed をランダムに回し、素朴なモデル（文字列のリスト）と突き合わせる
+//     （プールを何周も使い切るので compact() も繰り返し走る）
+//   - BBC 風の更新（3フィード×24件、1回の取得で2件入れ替わる、平均 75字）で件数が欠けないこと
+#include <unity.h>
+#include <stdio.h>
+#include <string>
+#include <vector>
+#include <set>
+#include <random>
+#include "HeadlineStore.h"
+
+void setUp() {}
+void tearDown() {}
+
+static HeadlineStore gStore; // 約9KB。スタックに置かない
+
+static std::string textAt(const HeadlineStore& s, int f, int i) {
+  uint8_t len;
+  const char* p = s.text(f, i, len);
+  return std::string(p, len);
+}
+
+static void test_dedupe_and_shared_tags() {
+  HeadlineStore& s = gStore;
+  s.clear();
+  KwTags t;
+  t.clear(); t.add(3);
+  s.beginFeed(0);
+  TEST_ASSERT_TRUE(s.add(0, "Markets rally", 13, &t));
+  TEST_ASSERT_TRUE(s.add(0, "Markets rally", 13));  // フィード内の重複は数えない
+  TEST_ASSERT_TRUE(s.add(0, "Storm hits coast", 16));
+  TEST_ASSERT_TRUE(s.add(0, "", 0));                // 空は無視
+  s.commitFeed(0);
+  TEST_ASSERT_EQUAL_INT(2, s.count(0));
+  TEST_ASSERT_EQUAL_UINT32(1, s.rev(0));
+
+  s.beginFeed(1);
+  TEST_ASSERT_TRUE(s.add(1, "Markets rally", 13));  // フィード間で共有（照合結果も最初のもの）
+  s.commitFeed(1);
+  TEST_ASSERT_EQUAL_INT(2, s.liveEntries());
+  TEST_ASSERT_EQUAL_UINT32(13 + 16, s.liveBytes());
+  TEST_ASSERT_TRUE(s.tags(1, 0).any());
+  TEST_ASSERT_EQUAL_UINT16(3, s.tags(1, 0).id[0]);
+  TEST_ASSERT_EQUAL_INT(1, s.taggedEntries());
+
+  // 取得中は旧リストを表示し続け、abort なら何も変わらない
+  s.beginFeed(0);
+  TEST_ASSERT_TRUE(s.add(0, "Brand new", 9));
+  TEST_ASSERT_EQUAL_INT(2, s.count(0));
+  TEST_ASSERT_EQUAL_INT(3, s.liveEntries());
+  s.abortFeed(0);
+  TEST_ASSERT_EQUAL_INT(2, s.liveEntries());
+  TEST_ASSERT_EQUAL_UINT32(1, s.rev(0));
+  TEST_ASSERT_EQUAL_STRING("Storm hits coast", textAt(s, 0, 1).c_str());
+
+  // 差し替えで参照が消えた見出しは空きに戻る（"Markets rally" はフィード1が使い続ける）
+  s.beginFeed(0);
+  TEST_ASSERT_TRUE(s.add(0, "Brand new", 9));
+  s.commitFeed(0);
+  TEST_ASSERT_EQUAL_INT(1, s.count(0));
+  TEST_ASSERT_EQUAL_INT(2, s.liveEntries());
+  TEST_ASSERT_EQUAL_UINT32(13 + 9, s.liveBytes());
+
+  // 長すぎる見出しは HL_TEXT_MAX で切る / copy は NUL 終端で切り詰める
+  std::string longT(HL_TEXT_MAX + 30, 'x');
+  s.beginFeed(2);
+  TEST_ASSERT_TRUE(s.add(2, longT.data(), longT.size()));
+  s.commitFeed(2);
+  TEST_ASSERT_EQUAL_UINT32(HL_TEXT_MAX, textAt(s, 2, 0).size());
+  char small[8];
+  TEST_ASSERT_EQUAL_UINT32(7, s.copy(2, 0, small, sizeof small));
+  TEST_ASSERT_EQUAL_STRING("xxxxxxx", small);
+  TEST_ASSERT_EQUAL_UINT32(0, s.copy(2, 5, small, sizeof small));
+  TEST_ASSERT_EQUAL_STRING("", small);
+}
+
+// ===================== モデルとの突き合わせ =====================
+struct Model {
+  std::vector<std::string> cur[HL_FEEDS], pend[HL_FEEDS];
+  uint32_t rev[HL_FEEDS] = {};
+
+  std::set<std::string> live() const {
+    std::set<std::string> u;
+    for (int f = 0; f < HL_FEEDS; f++) {
+      u.insert(cur[f].begin(), cur[f].end());
+      u.insert(pend[f].begin(), pend[f].end());
+    }
+    return u;
+  }
+  uint32_t liveBytes() const {
+    uint32_t n = 0;
+    std::set<std::string> u = live();
+    for (std::set<std::string>::const_iterator it = u.begin(); it != u.end(); ++it) n += it->size();
+    return n;
+  }
+  // HeadlineStore::add と同じ可否：件数上限 → 同じフィード内の重複 → 新規ならエントリとプールの空き
+  bool add(int f, const std::string& t) {
+    if (pend[f].size() >= (size_t)HL_MAX_PER_FEED) return false;
+    for (size_t i = 0; i < pend[f].size(); i++) if (pend[f][i] == t) return true;
+    std::set<std::string> u = live();
+    if (!u.count(t)) {
+      if (u.size() >= (size_t)HL_MAX_ENTRIES) return false;
+      if (liveBytes() + t.size() > HL_POOL_BYTES) return false; // 詰め直せば入るなら入る
+    }
+    pend[f].push_back(t);
+    return true;
+  }
+};
+
+static void expectSame(const HeadlineStore& s, const Model& m, int step) {
+  char msg[48];
+  snprintf(msg, sizeof msg, "step %d", step);
+  for (int f = 0; f < HL_FEEDS; f++) {
+    TEST_ASSERT_EQUAL_INT_MESSAGE((int)m.cur[f].size(), s.count(f), msg);
+    TEST_ASSERT_EQUAL_INT_MESSAGE((int)m.rev[f], (int)s.rev(f), msg);
+    for (int i = 0; i < s.count(f); i++)
+      TEST_ASSERT_TRUE_MESSAGE(textAt(s, f, i) == m.cur[f][i], msg);
+  }
+  TEST_ASSERT_EQUAL_INT_MESSAGE((int)m.live().size(), s.liveEntries(), msg);
+  TEST_ASSERT_EQUAL_INT_MESSAGE((int)m.liveBytes(), (int)s.liveBytes(), msg);
+}
+
+static void test_matches_model_under_random_ops() {
+  std::mt19937 rng(5);
+  // 見出しの母集団を小さめにして重複を起こし、長さはばらつかせてプールを詰まらせる
+  std::vector<std::string> universe;
+  for (int i = 0; i < 400; i++) {
+    int len = 20 + rng() % (HL_TEXT_MAX - 20);
+    std::string t = "#" + std::to_string(i) + " ";
+    while ((int)t.size() < len) t += (char)('a' + rng() % 26);
+    universe.push_back(t);
+  }
+
+  HeadlineStore& s = gStore;
+  s.clear();
+  Model m;
+  bool fetching[HL_FEEDS] = {};
+  uint64_t added = 0;
+  int fails = 0;
+  for (int step = 0; step < 200000; step++) {
+    int f = rng() % HL_FEEDS;
+    int op = rng() % 100;
+    if (!fetching[f] || op < 3) {                 // beginFeed（取得中なら捨てて始め直し）
+      s.beginFeed(f); m.pend[f].clear(); fetching[f] = true;
+    } else if (op < 85) {                          // add
+      const std::string& t = universe[rng() % universe.size()];
+      bool fresh = !m.live().count(t);
+      bool want  = m.add(f, t);
+      bool got   = s.add(f, t.data(), t.size());
+      TEST_ASSERT_EQUAL_MESSAGE(want, got, "add result differs from model");
+      if (!got) fails++;
+      else if (fresh) added += t.size(); // プールに新しく書いたバイト
+    } else if (op < 95) {                          // commitFeed
+      s.commitFeed(f); m.cur[f].swap(m.pend[f]); m.pend[f].clear(); m.rev[f]++; fetching[f] = false;
+    } else {                                       // abortFeed
+      s.abortFeed(f); m.pend[f].clear(); fetching[f] = false;
+    }
+    if (step % 16 == 0) expectSame(s, m, step);
+  }
+  expectSame(s, m, -1);
+  // 末尾に足していくだけならプールは数回で尽きる。何十周分も入ったので compact() が繰り返し走っている
+  TEST_ASSERT_TRUE(added > 50ull * HL_POOL_BYTES);
+  TEST_ASSERT_TRUE(fails > 0); // 満杯の経路も通っている
+
+  char msg[96];
+  snprintf(msg, sizeof msg, "200k ops: %llu B written to the pool (%.0fx its size), %d adds refused",
+           (unsigned long long)added, (double)added / HL_POOL_BYTES, fails);
+  TEST_MESSAGE(msg);
+}
+
+// ===================== BBC 風の更新 =====================
+// 各フィードは先頭に新着2件が入り、末尾2件が押し出される 24件のリスト。1回の取得 = 1フィード
+static void test_rolling_feeds_stay_full() {
+  std::mt19937 rng(6);
+  std::normal_distribution<double> lenDist(75.0, 18.0);
+  HeadlineStore& s = gStore;
+  s.clear();
+  std::vector<std::string> feed[HL_FEEDS];
+  int serial = 0;
+  auto title = [&]() {
+    int len = (int)lenDist(rng);
+    if (len < 25) len = 25;
+    if (len > HL_TEXT_MAX) len = HL_TEXT_MAX;
+    std::string t = "Story " + std::to_string(serial++) + ":";
+    while ((int)t.size() < len) t += (char)('a' + rng() % 26);
+    return t;
+  };
+  for (int f = 0; f < HL_FEEDS; f++)
+    for (int i = 0; i < HL_MAX_PER_FEED; i++) feed[f].push_back(title());
+
+  int shortCommits = 0;
+  uint32_t maxUsed = 0;
+  const int REFRESHES = 3000;
+  for (int r = 0; r < REFRESHES; r++) {
+    int f = r % HL_FEEDS;
+    if (r >= HL_FEEDS) {
+      feed[f].pop_back(); feed[f].pop_back();
+      feed[f].insert(feed[f].begin(), title());
+      feed[f].insert(feed[f].begin(), title());
+    }
+    s.beginFeed(f);
+    for (size_t i = 0; i < feed[f].size(); i++) s.add(f, feed[f][i].data(), feed[f][i].size());
+    if (s.liveBytes() > maxUsed) maxUsed = s.liveBytes();
+    s.commitFeed(f);
+    if (s.count(f) < HL_MAX_PER_FEED) shortCommits++;
+  }
+  TEST_ASSERT_EQUAL_INT(0, shortCommits);
+
+  char msg[120];
+  snprintf(msg, sizeof msg, "%d refreshes, 3x%d titles (avg ~75 chars): %d short commits, peak pool use %u / %u B",
+           REFRESHES, HL_MAX_PER_FEED, shortCommits, (unsigned)maxUsed, (unsigned)HL_POOL_BYTES);
+  TEST_MESSAGE(msg);
+}
+
+int main(int, char**) {
+  UNITY_BEGIN();
+  RUN_TEST(test_dedupe_and_shared_tags);
+  RUN_TEST(test_matches_model_under_random_ops);
+  RUN_TEST(test_rolling_feeds_stay_full);
+  return UNITY_END();
+}
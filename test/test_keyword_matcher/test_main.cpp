@@ -0,0 +1,253 @@
+// KeywordMatcher.h のホストテスト（pio test -e native -f test_keyword_matcher）
+//   - ランダムなキーワード / 見出しで、総当たり（正規化した文字列の find）とヒット数・番号を突き合わせる
+//   - KwTextFilter：生の RSS 本文を、表示側の整形（タグ除去→実体参照展開→タグ除去）と同じ文字列にして照合する
+//   - キーワード 10 / 100 / 500 個での 1バイトあたりの照合時間と表の大きさを出力する
+#include <unity.h>
+#include <stdio.h>
+#include <ctype.h>
+#include <time.h>
+#include <string>
+#include <vector>
+#include <set>
+#include <random>
+#include "KeywordMatcher.h"
+
+void setUp() {}
+void tearDown() {}
+
+static double nowNs() {
+  struct timespec ts;
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  return ts.tv_sec * 1e9 + ts.tv_nsec;
+}
+
+static bool matches(KeywordMatcher& m, const char* text, KwTags& t) {
+  m.beginText(t);
+  m.feed(text, strlen(text), t);
+  m.endText(t);
+  return t.any();
+}
+
+static void test_word_boundaries_and_case() {
+  static const char* const KW[] = {" ai ", "nvidia", "s&p", " yen "};
+  KeywordMatcher m;
+  TEST_ASSERT_TRUE(m.build(KW, 4));
+  KwTags t;
+  TEST_ASSERT_FALSE(matches(m, "Minister said nothing", t));       // " ai " は単語単位
+  TEST_ASSERT_TRUE(matches(m, "AI chips lift Nvidia shares", t));  // 先頭は区切り扱い
+  TEST_ASSERT_EQUAL_UINT8(2, t.n);
+  TEST_ASSERT_EQUAL_UINT16(0, t.id[0]);
+  TEST_ASSERT_EQUAL_UINT16(1, t.id[1]);
+  TEST_ASSERT_TRUE(matches(m, "Rally in the S&P 500", t));         // '&' はキーワードの一部
+  TEST_ASSERT_FALSE(matches(m, "Yenta sees SP gains", t));
+  TEST_ASSERT_TRUE(matches(m, "Strong yen, weak stocks", t));      // ',' は区切り
+  TEST_ASSERT_TRUE(matches(m, "Weak yen", t));                      // 末尾も区切り扱い
+}
+
+static bool matchesRaw(KeywordMatcher& m, const char* raw, KwTags& t) {
+  KwTextFilter f;
+  m.beginText(t); f.begin();
+  f.feed(raw, strlen(raw), m, t);
+  f.end(m, t);
+  m.endText(t);
+  return t.any();
+}
+
+static void test_raw_rss_text() {
+  static const char* const KW[] = {" ai ", "s&p", " japan ", " 39 "};
+  KeywordMatcher m;
+  TEST_ASSERT_TRUE(m.build(KW, 4));
+  KwTags t;
+  TEST_ASSERT_TRUE(matchesRaw(m, "Rally in the S&amp;P 500", t));   // 配信上の '&' は &amp;
+  TEST_ASSERT_EQUAL_UINT16(1, t.id[0]);
+  TEST_ASSERT_FALSE(matches(m, "Rally in the S&amp;P 500", t));     // 生バイトのままでは一致しない
+  TEST_ASSERT_TRUE(matchesRaw(m, "&#39;AI&#39; boom", t));          // 表示は 'AI' boom
+  TEST_ASSERT_EQUAL_UINT8(1, t.n);
+  TEST_ASSERT_EQUAL_UINT16(0, t.id[0]);
+  TEST_ASSERT_FALSE(matchesRaw(m, "It&#39;s a &#39;fault&#39;", t)); // 実体参照の数字は本文に入らない
+  TEST_ASSERT_TRUE(matchesRaw(m, "&lt;b&gt;Japan&lt;/b&gt; rates", t)); // 展開後のタグも除去
+  TEST_ASSERT_FALSE(matchesRaw(m, "<a href=\"/ai japan\">Rates</a>", t)); // 属性の中は照合しない
+  TEST_ASSERT_TRUE(matchesRaw(m, "S&amp;amp;P vs S&amp;P", t));    // &amp;amp; は "&amp;" のまま
+  TEST_ASSERT_EQUAL_UINT8(1, t.hits);
+  TEST_ASSERT_TRUE(matchesRaw(m, "5 < 6 in Japan", t));             // タグでない '<' は文字
+}
+
+static void test_build_rejects_bad_input() {
+  KeywordMatcher m;
+  TEST_ASSERT_FALSE(m.build(nullptr, 0));
+  TEST_ASSERT_FALSE(m.ready());
+  KwTags t;
+  TEST_ASSERT_FALSE(matches(m, "anything", t)); // 未構築なら何にも一致しない
+}
+
+// 総当たり：キーワードに使われていない記号・空白を ' ' に、英字を小文字にした文字列を両端 ' ' で囲み、
+// 各キーワード（重複は先のもの）の出現をすべて数える
+static void test_matches_brute_force() {
+  std::mt19937 rng(1);
+  const char* alpha = "abcdefghij ,.&";
+  std::vector<std::string> kws;
+  for (int i = 0; i < 300; i++) {
+    int L = 1 + rng() % 6;
+    std::string s;
+    for (int j = 0; j < L; j++) s += alpha[rng() % 14];
+    if (rng() % 5 == 0) s = " " + s + " ";
+    kws.push_back(s);
+  }
+  std::vector<const char*> p;
+  for (size_t i = 0; i < kws.size(); i++) p.push_back(kws[i].c_str());
+  KeywordMatcher m;
+  TEST_ASSERT_TRUE(m.build(p.data(), (int)p.size()));
+
+  bool used[256] = {};
+  for (size_t i = 0; i < kws.size(); i++)
+    for (size_t j = 0; j < kws[i].size(); j++)
+      if (kws[i][j] != ' ') used[tolower((unsigned char)kws[i][j])] = true;
+
+  std::vector<std::string> norm;
+  std::set<std::string> seen;
+  std::vector<int> ids;
+  for (size_t k = 0; k < kws.size(); k++) {
+    if (!seen.insert(kws[k]).second) continue;
+    norm.push_back(kws[k]);
+    ids.push_back((int)k);
+  }
+
+  for (int it = 0; it < 3000; it++) {
+    int L = rng() % 80;
+    std::string t;
+    for (int j = 0; j < L; j++) {
+      char c = alpha[rng() % 14];
+      if (rng() % 3 == 0) c = (char)toupper(c);
+      if (rng() % 20 == 0) c = 'X'; // キーワードにない英字（区切りではない）
+      t += c;
+    }
+    KwTags tg;
+    m.beginText(tg); m.feed(t.data(), t.size(), tg); m.endText(tg);
+
+    std::string nt = " ";
+    for (size_t j = 0; j < t.size(); j++) {
+      unsigned char c = (unsigned char)t[j];
+      nt += (isalnum(c) || used[tolower(c)]) ? (char)tolower(c) : ' ';
+    }
+    nt += " ";
+    int hits = 0;
+    std::set<int> found;
+    for (size_t k = 0; k < norm.size(); k++)
+      for (size_t pos = 0; (pos = nt.find(norm[k], pos)) != std::string::npos; pos++) { hits++; found.insert(ids[k]); }
+
+    TEST_ASSERT_EQUAL_INT_MESSAGE(hits > 255 ? 255 : hits, tg.hits, t.c_str());
+    TEST_ASSERT_EQUAL_INT_MESSAGE(found.size() < (size_t)KW_TAGS_MAX ? found.size() : KW_TAGS_MAX, tg.n, t.c_str());
+    for (int i = 0; i < tg.n; i++) TEST_ASSERT_TRUE_MESSAGE(found.count(tg.id[i]), t.c_str());
+  }
+}
+
+// 表示側の整形（main.cpp の stripHtmlTags / decodeEntities と同じ規則）
+static std::string refStrip(const std::string& s) {
+  std::string out;
+  bool inTag = false;
+  for (size_t i = 0; i < s.size(); i++) {
+    char c = s[i];
+    if (!inTag && c == '<') {
+      char nx = (i + 1 < s.size()) ? s[i + 1] : '\0';
+      if (isalpha((unsigned char)nx) || nx == '/' || nx == '!') { inTag = true; continue; }
+    }
+    if (inTag && c == '>') { inTag = false; continue; }
+    if (!inTag) out += c;
+  }
+  return out;
+}
+
+static void refReplace(std::string& s, const char* from, const char* to) {
+  std::string out;
+  size_t n = strlen(from), pos = 0;
+  for (size_t hit; (hit = s.find(from, pos)) != std::string::npos; pos = hit + n) out += s.substr(pos, hit - pos) + to;
+  s = out + s.substr(pos);
+}
+
+static std::string refDisplay(const std::string& raw) {
+  std::string s = refStrip(raw);
+  refReplace(s, "&amp;", "&");
+  refReplace(s, "&lt;", "<");
+  refReplace(s, "&gt;", ">");
+  refReplace(s, "&quot;", "\"");
+  refReplace(s, "&apos;", "'");
+  refReplace(s, "&#39;", "'");
+  return refStrip(s);
+}
+
+// 実体参照・タグの断片を混ぜた本文で、フィルタ経由の照合と「整形後の文字列を照合」が一致すること
+static void test_raw_filter_matches_display_text() {
+  static const char* const KW[] = {"s&p", "a<b", " amp ", "l'", "\"q", " 39 ", "t>", "<"};
+  KeywordMatcher m;
+  TEST_ASSERT_TRUE(m.build(KW, 8));
+  static const char* const PIECES[] = {"&", "amp;", "lt;", "gt;", "quot;", "apos;", "#39;", "&amp;", "&lt;", "&gt;",
+                                       "<", ">", "/", "!", "b", "a", "l", "p", "t", "s", "q", "3", "9", " ", ";", "#"};
+  const int NP = sizeof(PIECES) / sizeof(PIECES[0]);
+  std::mt19937 rng(3);
+  int hitTexts = 0;
+  for (int it = 0; it < 50000; it++) {
+    std::string raw;
+    int L = rng() % 24;
+    for (int j = 0; j < L; j++) raw += PIECES[rng() % NP];
+    std::string shown = refDisplay(raw);
+    KwTags want, got;
+    matches(m, shown.c_str(), want);
+    matchesRaw(m, raw.c_str(), got);
+    std::string msg = raw + " -> " + shown;
+    TEST_ASSERT_EQUAL_INT_MESSAGE(want.hits, got.hits, msg.c_str());
+    TEST_ASSERT_EQUAL_INT_MESSAGE(want.n, got.n, msg.c_str());
+    for (int i = 0; i < want.n; i++) TEST_ASSERT_EQUAL_INT_MESSAGE(want.id[i], got.id[i], msg.c_str());
+    if (want.any()) hitTexts++;
+  }
+  TEST_ASSERT_GREATER_THAN(5000, hitTexts);
+}
+
+static void test_bench_keyword_counts() {
+  std::mt19937 rng(2);
+  std::string txt;
+  for (int i = 0; i < (1 << 21); i++) txt += (rng() % 6 == 0) ? ' ' : (char)('a' + rng() % 26);
+
+  const int counts[] = {10, 100, 500};
+  for (int c = 0; c < 3; c++) {
+    const int n = counts[c];
+    std::vector<std::string> kws;
+    for (int i = 0; i < n; i++) {
+      int L = 4 + rng() % 6;
+      std::string s;
+      for (int j = 0; j < L; j++) s += (char)('a' + rng() % 26);
+      kws.push_back(s);
+    }
+    std::vector<const char*> p;
+    for (int i = 0; i < n; i++) p.push_back(kws[i].c_str());
+    KeywordMatcher m;
+    TEST_ASSERT_TRUE(m.build(p.data(), n));
+
+    KwTags tg;
+    double t0 = nowNs();
+    m.beginText(tg); m.feed(txt.data(), txt.size(), tg); m.endText(tg);
+    double ac = (nowNs() - t0) / txt.size();
+
+    size_t naive = 0;
+    t0 = nowNs();
+    for (int i = 0; i < n; i++)
+      for (size_t pos = 0; (pos = txt.find(kws[i], pos)) != std::string::npos; pos++) naive++;
+    double nv = (nowNs() - t0) / txt.size();
+
+    char msg[200];
+    snprintf(msg, sizeof msg,
+             "%d keywords: %d states, %d classes, table %u B; Aho-Corasick %.2f ns/B vs per-keyword find %.2f ns/B",
+             n, m.states(), m.classes(), (unsigned)m.tableBytes(), ac, nv);
+    TEST_MESSAGE(msg);
+  }
+}
+
+int main(int, char**) {
+  UNITY_BEGIN();
+  RUN_TEST(test_word_boundaries_and_case);
+  RUN_TEST(test_raw_rss_text);
+  RUN_TEST(test_build_rejects_bad_input);
+  RUN_TEST(test_matches_brute_force);
+  RUN_TEST(test_raw_filter_matches_display_text);
+  RUN_TEST(test_bench_keyword_counts);
+  return UNITY_END();
+}
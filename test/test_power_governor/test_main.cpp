@@ -0,0 +1,158 @@
+// PowerGovernor.h のホストテスト（pio test -e native -f test_power_governor）
+// 偽の時計（ms と現地の時）を渡して、モード遷移と集計を確かめる。
+#include <unity.h>
+#include <stdio.h>
+#include "PowerGovernor.h"
+
+void setUp() {}
+void tearDown() {}
+
+static const uint32_t MIN_MS = 60 * 1000;
+
+static void test_idle_is_opt_in() {
+  PowerGovernor g;
+  g.begin(1000);
+  // 既定（idleAfterMs = 0）では昼間はずっと ACTIVE
+  TEST_ASSERT_FALSE(g.update(1000 + 24 * 60 * MIN_MS, 12));
+  TEST_ASSERT_EQUAL(PWR_ACTIVE, g.mode());
+}
+
+static void test_idle_timeout() {
+  PowerGovernor g;
+  g.cfg.idleAfterMs = 5 * MIN_MS;
+  uint32_t t = 1000;
+  g.begin(t);
+  TEST_ASSERT_FALSE(g.update(t + 5 * MIN_MS - 1, 12));
+  TEST_ASSERT_EQUAL(PWR_ACTIVE, g.mode());
+  TEST_ASSERT_TRUE(g.update(t + 5 * MIN_MS, 12));
+  TEST_ASSERT_EQUAL(PWR_IDLE, g.mode());
+  TEST_ASSERT_FALSE(g.update(t + 5 * MIN_MS, -1)); // 時刻不明なら夜間扱いしない
+  TEST_ASSERT_EQUAL(PWR_IDLE, g.mode());
+
+  // 押下で戻り、タイムアウトは押下から数え直し
+  t += 6 * MIN_MS;
+  TEST_ASSERT_TRUE(g.onInput(t));
+  TEST_ASSERT_FALSE(g.update(t + 5 * MIN_MS - 1, 12));
+  TEST_ASSERT_TRUE(g.update(t + 5 * MIN_MS, 12));
+  TEST_ASSERT_EQUAL_UINT32(3, g.transitions());
+}
+
+static void test_night_window_wraps_midnight() {
+  PowerGovernor g;
+  TEST_ASSERT_TRUE(g.isNight(23));
+  TEST_ASSERT_TRUE(g.isNight(0));
+  TEST_ASSERT_TRUE(g.isNight(5));
+  TEST_ASSERT_FALSE(g.isNight(6));
+  TEST_ASSERT_FALSE(g.isNight(22));
+  TEST_ASSERT_FALSE(g.isNight(-1));
+  g.cfg.nightStart = 1; g.cfg.nightEnd = 5; // 日をまたがない窓
+  TEST_ASSERT_TRUE(g.isNight(1));
+  TEST_ASSERT_FALSE(g.isNight(5));
+  TEST_ASSERT_FALSE(g.isNight(0));
+}
+
+// 夜間は入力に関係なく時刻で NIGHT（起動直後と押下後の wakeHoldMs だけ ACTIVE）
+static void test_night_follows_schedule() {
+  PowerGovernor g;
+  uint32_t t = 5000;
+  g.begin(t);
+  TEST_ASSERT_FALSE(g.update(t + g.cfg.wakeHoldMs - 1, 23));
+  TEST_ASSERT_TRUE(g.update(t + g.cfg.wakeHoldMs, 23));
+  TEST_ASSERT_EQUAL(PWR_NIGHT, g.mode());
+  t += g.cfg.wakeHoldMs;
+  TEST_ASSERT_FALSE(g.update(t + 3 * 60 * MIN_MS, 2));
+  TEST_ASSERT_TRUE(g.update(t + 7 * 60 * MIN_MS, 6)); // 朝6時で ACTIVE（IDLE は無効のまま）
+  TEST_ASSERT_EQUAL(PWR_ACTIVE, g.mode());
+
+  // IDLE を有効にしていても夜間帯は NIGHT
+  PowerGovernor h;
+  h.cfg.idleAfterMs = 5 * MIN_MS;
+  h.begin(0);
+  TEST_ASSERT_TRUE(h.update(10 * MIN_MS, 12));
+  TEST_ASSERT_EQUAL(PWR_IDLE, h.mode());
+  TEST_ASSERT_TRUE(h.update(11 * MIN_MS, 23));
+  TEST_ASSERT_EQUAL(PWR_NIGHT, h.mode());
+  TEST_ASSERT_TRUE(h.update(12 * MIN_MS, 6));
+  TEST_ASSERT_EQUAL(PWR_IDLE, h.mode());
+}
+
+// NIGHT 中の押下は復帰だけに使い（true）、2回目からは通常の操作（false）。
+// wakeHoldMs を過ぎたら押下がなければ NIGHT に戻る
+static void test_wake_press_is_swallowed() {
+  PowerGovernor g;
+  g.begin(0);
+  TEST_ASSERT_TRUE(g.update(2 * MIN_MS, 1));
+  TEST_ASSERT_EQUAL(PWR_NIGHT, g.mode());
+
+  uint32_t t = 10 * MIN_MS;
+  TEST_ASSERT_TRUE(g.onInput(t));
+  TEST_ASSERT_EQUAL(PWR_ACTIVE, g.mode());
+  TEST_ASSERT_FALSE(g.update(t + 10, 1)); // 押下直後の周期評価で NIGHT に戻さない
+  TEST_ASSERT_FALSE(g.onInput(t + 500));
+  TEST_ASSERT_FALSE(g.update(t + 500 + g.cfg.wakeHoldMs - 1, 1));
+  TEST_ASSERT_TRUE(g.update(t + 500 + g.cfg.wakeHoldMs, 1));
+  TEST_ASSERT_EQUAL(PWR_NIGHT, g.mode());
+}
+
+// millis() の一周（49.7日）をまたいでも判定が崩れない
+static void test_millis_wrap() {
+  PowerGovernor g;
+  g.cfg.idleAfterMs = 5 * MIN_MS;
+  const uint32_t t0 = 0xFFFFFF00u;
+  g.begin(t0);
+  TEST_ASSERT_FALSE(g.update(0x100, 12)); // 一周直後（経過 512ms）
+  TEST_ASSERT_EQUAL(PWR_ACTIVE, g.mode());
+  TEST_ASSERT_TRUE(g.update(t0 + 5 * MIN_MS, 12));
+  TEST_ASSERT_EQUAL(PWR_IDLE, g.mode());
+
+  // 押下なしで 50 日（30秒刻み）回しても、millis() の一周で経過が小さく見えて ACTIVE に戻らない
+  PowerGovernor h;
+  h.begin(0);
+  uint32_t t = 0;
+  for (int i = 0; i < 50 * 24 * 120; i++) {
+    t += MIN_MS / 2; // 最初の2回は起動直後の wakeHoldMs 内
+    h.update(t, 2);
+    if (i >= 2) TEST_ASSERT_EQUAL_MESSAGE(PWR_NIGHT, h.mode(), "woke up without input");
+  }
+}
+
+static void test_stats_and_model() {
+  PowerGovernor g;
+  g.begin(0);
+  for (int i = 1; i <= 1000; i++) {
+    g.noteWakes(1, 2000);
+    g.update((uint32_t)i * 33, 12);
+  }
+  PowerStats s = g.stats(PWR_ACTIVE, 33000);
+  TEST_ASSERT_EQUAL_UINT32(33000, (uint32_t)s.ms);
+  TEST_ASSERT_EQUAL_UINT32(1000, s.wakes);
+  TEST_ASSERT_FLOAT_WITHIN(0.1f, 30.3f, g.wakesPerSec(PWR_ACTIVE, 33000));
+  TEST_ASSERT_FLOAT_WITHIN(0.001f, 2.0f / 33.0f, g.busyFrac(PWR_ACTIVE, 33000));
+
+  // 滞在実績のないモードは設定値から見積もる。NIGHT < IDLE < ACTIVE
+  float a = g.estimateMwhPerHour(PWR_ACTIVE, 33000);
+  float i = g.estimateMwhPerHour(PWR_IDLE, 33000);
+  float n = g.estimateMwhPerHour(PWR_NIGHT, 33000);
+  TEST_ASSERT_TRUE(n < i && i < a);
+
+  char msg[120];
+  snprintf(msg, sizeof msg, "model mW: active %.0f idle %.0f night %.0f", a, i, n);
+  TEST_MESSAGE(msg);
+}
+
+static void test_poll_short_enough_for_taps() {
+  for (int m = 0; m < PWR_MODE_COUNT; m++) TEST_ASSERT_TRUE(POWER_PROFILES[m].pollMs <= 30);
+}
+
+int main(int, char**) {
+  UNITY_BEGIN();
+  RUN_TEST(test_idle_is_opt_in);
+  RUN_TEST(test_idle_timeout);
+  RUN_TEST(test_night_window_wraps_midnight);
+  RUN_TEST(test_night_follows_schedule);
+  RUN_TEST(test_wake_press_is_swallowed);
+  RUN_TEST(test_millis_wrap);
+  RUN_TEST(test_stats_and_model);
+  RUN_TEST(test_poll_short_enough_for_taps);
+  return UNITY_END();
+}
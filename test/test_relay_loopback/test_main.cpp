@@ -0,0 +1,539 @@
+// RelayProto.h のホストテスト（pio test -e native -f test_relay_loopback）
+//   - 全メッセージ種別のエンコード / デコード往復（epoch・分割 NEWS を含む）
+//   - 実機と同じ RelayServer / RelayClient を、共有状態の代わりに記録用の Host で動かす
+//     （SERVER の再起動・古い分割 NEWS の破棄・取りこぼしからの復帰・遅れによるフォールバック）
+//   - ループバックのマルチキャストで 1送信 → K受信 の伝送遅延（送信から各受信側のデコードまで）
+//   - 1時間分の取得スケジュールを SERVER 1台 + CLIENT K台で回し、SERVER 停止中の直接取得も含めて
+//     上流リクエスト数を数える
+// マルチキャストが使えない環境（lo に MULTICAST がない等）ではソケットを使うテストを IGNORE にする。
+#include <unity.h>
+#include <stdio.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+#include <fcntl.h>
+#include <poll.h>
+#include <errno.h>
+#include <sys/socket.h>
+#include <netinet/in.h>
+#include <arpa/inet.h>
+#include <vector>
+#include <algorithm>
+#include <string>
+#include "RelayProto.h"
+
+void setUp() {}
+void tearDown() {}
+
+static const uint16_t TEST_PORT  = 41299; // 実機の RELAY_PORT とは別にする
+static const char*    TEST_GROUP = "239.77.77.1";
+static const int      RECEIVERS  = 4;
+
+static double nowUs() {
+  struct timespec ts;
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  return ts.tv_sec * 1e6 + ts.tv_nsec * 1e-3;
+}
+
+// ===================== Host =====================
+// 見出しの供給元（HeadlineStore の count / text と同じ形）
+struct VecNews {
+  std::vector<std::string> t[RELAY_FEEDS];
+  int count(int f) const { return (int)t[f].size(); }
+  const char* text(int f, int i, uint8_t& len) const { len = (uint8_t)t[f][i].size(); return t[f][i].data(); }
+};
+
+// SERVER 側：送ったパケットを溜める（ソケットへの送信は呼び出し側）
+struct CaptureHost {
+  VecNews news;
+  double  btc = 15000000.0;
+  std::string rates = "USD/JPY 150.00";
+  std::vector<std::vector<uint8_t> > out;
+  int locked = 0;
+
+  void relaySend(const uint8_t* p, size_t n) {
+    TEST_ASSERT_EQUAL_INT(0, locked); // 送信はロックの外
+    out.push_back(std::vector<uint8_t>(p, p + n));
+  }
+  double relayBtc() { return btc; }
+  void relayRates(char* o, size_t cap) { snprintf(o, cap, "%s", rates.c_str()); }
+  const VecNews& relayNewsLock() { locked++; return news; }
+  void relayNewsUnlock() { locked--; }
+};
+
+// CLIENT 側：適用結果を記録する（取得中 / 表示中の見出しリストを分けて持つ）
+struct RecordHost {
+  double   btc = 0.0;
+  std::string rates;
+  std::vector<std::string> staged[RELAY_FEEDS], shown[RELAY_FEEDS];
+  uint32_t commits = 0, aborts = 0, resyncs = 0;
+
+  void relayApplyBtc(double p) { btc = p; }
+  void relayApplyRates(const char* s, size_t len) { rates.assign(s, len); }
+  void relayNewsBegin(int f) { staged[f].clear(); }
+  void relayNewsTitle(int f, const char* s, uint8_t len) { staged[f].push_back(std::string(s, len)); }
+  void relayNewsCommit(int f) { shown[f].swap(staged[f]); staged[f].clear(); commits++; }
+  void relayNewsAbort(int f) { staged[f].clear(); aborts++; }
+  void relayResynced() { resyncs++; }
+};
+
+// パケット列をデコードして CLIENT に渡す。戻り値 = 適用された差分の数
+static int deliver(RelayClient& c, RecordHost& h, const std::vector<std::vector<uint8_t> >& pk, uint32_t at,
+                   size_t from = 0, size_t to = (size_t)-1) {
+  int applied = 0;
+  for (size_t i = from; i < pk.size() && i < to; i++) {
+    RelayMsg m;
+    TEST_ASSERT_TRUE(relayDecode(pk[i].data(), pk[i].size(), m));
+    if (c.onPacket(m, at, h)) applied++;
+  }
+  return applied;
+}
+
+static std::vector<std::string> makeTitles(int n, int salt) {
+  std::vector<std::string> v;
+  for (int i = 0; i < n; i++) {
+    char b[200];
+    int len = snprintf(b, sizeof b, "Headline %d/%d: ", salt, i);
+    for (; len < 90 + (i * 7) % 60; len++) b[len] = (char)('a' + (i + len) % 26);
+    v.push_back(std::string(b, len));
+  }
+  return v;
+}
+
+// ===================== 往復 =====================
+static void test_roundtrip_all_types() {
+  uint8_t buf[RELAY_MAX_PACKET];
+  RelayMsg m;
+
+  size_t n = relayEncodeBtc(buf, sizeof buf, 7, 0xA1B2C3D4, 1, 15234567.5, 321);
+  TEST_ASSERT_TRUE(n > RELAY_HDR_SZ);
+  TEST_ASSERT_TRUE(relayDecode(buf, n, m));
+  TEST_ASSERT_EQUAL(RELAY_T_BTC, m.type);
+  TEST_ASSERT_EQUAL_UINT16(7, m.seq);
+  TEST_ASSERT_EQUAL_UINT32(0xA1B2C3D4, m.epoch);
+  TEST_ASSERT_EQUAL_UINT32(1, m.rev);
+  TEST_ASSERT_EQUAL_UINT32(321, m.ageMs);
+  TEST_ASSERT_TRUE(m.price == 15234567.5);
+
+  n = relayEncodeRates(buf, sizeof buf, 8, 42, 3, 50, "USD/JPY 150.12  EUR/JPY 162.40");
+  m = RelayMsg();
+  TEST_ASSERT_TRUE(relayDecode(buf, n, m));
+  TEST_ASSERT_EQUAL(RELAY_T_RATES, m.type);
+  TEST_ASSERT_EQUAL_UINT32(42, m.epoch);
+  TEST_ASSERT_EQUAL_UINT32(3, m.rev);
+  TEST_ASSERT_EQUAL_STRING_LEN("USD/JPY 150.12  EUR/JPY 162.40", m.text, m.textLen);
+
+  const uint32_t revs[RELAY_FEEDS] = {4, 5, 6};
+  n = relayEncodeHeartbeat(buf, sizeof buf, 9, 42, 10, 11, revs, 123456);
+  m = RelayMsg();
+  TEST_ASSERT_TRUE(relayDecode(buf, n, m));
+  TEST_ASSERT_EQUAL(RELAY_T_HEARTBEAT, m.type);
+  TEST_ASSERT_EQUAL_UINT32(42, m.epoch);
+  TEST_ASSERT_EQUAL_UINT32(10, m.btcRev);
+  TEST_ASSERT_EQUAL_UINT32(11, m.ratesRev);
+  TEST_ASSERT_EQUAL_UINT32(6, m.newsRev[2]);
+  TEST_ASSERT_EQUAL_UINT32(123456, m.uptimeMs);
+
+  // 24件 × 90〜150文字 → RelayServer が複数パケットに分け、全件が順に戻ること
+  RelayServer srv;
+  srv.epoch = 42;
+  CaptureHost h;
+  h.news.t[2] = makeTitles(24, 1);
+  srv.noteNews(2, 0);
+  srv.pump(5, buf, sizeof buf, h);
+  const std::vector<std::vector<uint8_t> >& pk = h.out;
+  TEST_ASSERT_TRUE(pk.size() >= 2);
+  size_t k = 0;
+  for (size_t p = 0; p < pk.size(); p++) {
+    TEST_ASSERT_TRUE(pk[p].size() <= RELAY_MAX_PACKET);
+    m = RelayMsg();
+    TEST_ASSERT_TRUE(relayDecode(pk[p].data(), pk[p].size(), m));
+    TEST_ASSERT_EQUAL(RELAY_T_NEWS, m.type);
+    TEST_ASSERT_EQUAL_UINT16(p, m.seq);
+    TEST_ASSERT_EQUAL_UINT8(2, m.feed);
+    TEST_ASSERT_EQUAL_UINT32(1, m.rev);
+    TEST_ASSERT_EQUAL_UINT32(5, m.ageMs);
+    TEST_ASSERT_EQUAL_UINT8(p, m.part);
+    TEST_ASSERT_EQUAL_UINT8(pk.size(), m.parts);
+    RelayReader r((const uint8_t*)m.text, m.textLen);
+    const char* t; uint8_t len;
+    while (relayNextTitle(r, t, len)) {
+      TEST_ASSERT_EQUAL_UINT32(h.news.t[2][k].size(), len);
+      TEST_ASSERT_EQUAL_MEMORY(h.news.t[2][k].data(), t, len);
+      k++;
+    }
+  }
+  TEST_ASSERT_EQUAL_UINT32(h.news.t[2].size(), k);
+}
+
+static void test_decode_rejects_bad_packets() {
+  uint8_t buf[64];
+  RelayMsg m;
+  size_t n = relayEncodeBtc(buf, sizeof buf, 1, 1, 1, 1.0, 0);
+  TEST_ASSERT_FALSE(relayDecode(buf, n - 1, m));  // 切り詰め
+  TEST_ASSERT_FALSE(relayDecode(buf, RELAY_HDR_SZ - 1, m));
+  buf[2] = RELAY_VERSION - 1;                      // 旧版
+  TEST_ASSERT_FALSE(relayDecode(buf, n, m));
+  buf[2] = RELAY_VERSION; buf[0] = 'X';
+  TEST_ASSERT_FALSE(relayDecode(buf, n, m));
+  TEST_ASSERT_EQUAL_UINT32(0, relayEncodeBtc(buf, RELAY_HDR_SZ + 3, 1, 1, 1, 1.0, 0)); // 容量不足
+}
+
+// ===================== ソケット =====================
+struct Loopback {
+  int tx = -1;
+  int rx[RECEIVERS];
+  struct sockaddr_in dst;
+
+  bool open() {
+    for (int i = 0; i < RECEIVERS; i++) rx[i] = -1;
+    tx = socket(AF_INET, SOCK_DGRAM, 0);
+    if (tx < 0) return false;
+    struct in_addr lo; lo.s_addr = htonl(INADDR_LOOPBACK);
+    unsigned char ttl = 1, loop = 1;
+    if (setsockopt(tx, IPPROTO_IP, IP_MULTICAST_IF, &lo, sizeof lo) < 0) return false;
+    setsockopt(tx, IPPROTO_IP, IP_MULTICAST_TTL, &ttl, sizeof ttl);
+    setsockopt(tx, IPPROTO_IP, IP_MULTICAST_LOOP, &loop, sizeof loop);
+    memset(&dst, 0, sizeof dst);
+    dst.sin_family = AF_INET;
+    dst.sin_port   = htons(TEST_PORT);
+    inet_pton(AF_INET, TEST_GROUP, &dst.sin_addr);
+
+    for (int i = 0; i < RECEIVERS; i++) {
+      int s = socket(AF_INET, SOCK_DGRAM, 0);
+      if (s < 0) return false;
+      rx[i] = s;
+      int one = 1, rcvbuf = 1 << 20;
+      setsockopt(s, SOL_SOCKET, SO_REUSEADDR, &one, sizeof one);
+      setsockopt(s, SOL_SOCKET, SO_RCVBUF, &rcvbuf, sizeof rcvbuf);
+      struct sockaddr_in a;
+      memset(&a, 0, sizeof a);
+      a.sin_family = AF_INET;
+      a.sin_port   = htons(TEST_PORT);
+      a.sin_addr   = dst.sin_addr;
+      if (bind(s, (struct sockaddr*)&a, sizeof a) < 0) return false;
+      struct ip_mreq mr;
+      mr.imr_multiaddr = dst.sin_addr;
+      mr.imr_interface = lo;
+      if (setsockopt(s, IPPROTO_IP, IP_ADD_MEMBERSHIP, &mr, sizeof mr) < 0) return false;
+      fcntl(s, F_SETFL, O_NONBLOCK);
+    }
+    return true;
+  }
+  void close() {
+    if (tx >= 0) ::close(tx);
+    for (int i = 0; i < RECEIVERS; i++) if (rx[i] >= 0) ::close(rx[i]);
+    tx = -1;
+  }
+  bool send(const uint8_t* p, size_t n) {
+    return sendto(tx, p, n, 0, (struct sockaddr*)&dst, sizeof dst) == (ssize_t)n;
+  }
+  // 受信側 i から1パケット。timeoutMs 待っても来なければ 0
+  int recv(int i, uint8_t* buf, size_t cap, int timeoutMs) {
+    struct pollfd pf = {rx[i], POLLIN, 0};
+    if (poll(&pf, 1, timeoutMs) <= 0) return 0;
+    ssize_t n = ::recv(rx[i], buf, cap, 0);
+    return n > 0 ? (int)n : 0;
+  }
+};
+
+static double pct(std::vector<double> v, double p) {
+  std::sort(v.begin(), v.end());
+  return v[(size_t)(p * (v.size() - 1))];
+}
+
+static void test_loopback_transit_latency() {
+  Loopback lb;
+  if (!lb.open()) { lb.close(); TEST_IGNORE_MESSAGE("multicast loopback unavailable"); }
+
+  const int N = 500;
+  std::vector<double> sentAt(N), delivery, fanout;
+  uint8_t buf[RELAY_MAX_PACKET];
+  int lost = 0;
+  for (int i = 0; i < N; i++) {
+    size_t n = relayEncodeBtc(buf, sizeof buf, (uint16_t)i, 1, (uint32_t)i + 1, 15000000.0 + i, 0);
+    sentAt[i] = nowUs();
+    TEST_ASSERT_TRUE(lb.send(buf, n));
+    double last = 0;
+    for (int r = 0; r < RECEIVERS; r++) {
+      RelayMsg m;
+      int len = lb.recv(r, buf, sizeof buf, 200);
+      if (len <= 0 || !relayDecode(buf, (size_t)len, m) || m.seq != (uint16_t)i) { lost++; continue; }
+      double d = nowUs() - sentAt[i];
+      delivery.push_back(d);
+      if (d > last) last = d;
+    }
+    fanout.push_back(last);
+  }
+  lb.close();
+  TEST_ASSERT_EQUAL_INT(0, lost);
+
+  char msg[200];
+  snprintf(msg, sizeof msg,
+           "loopback transit (send->decode, %d receivers, %d pkts): p50 %.1f us  p99 %.1f us  max %.1f us; "
+           "fan-out to last receiver p50 %.1f us  p99 %.1f us",
+           RECEIVERS, N, pct(delivery, 0.5), pct(delivery, 0.99), pct(delivery, 1.0),
+           pct(fanout, 0.5), pct(fanout, 0.99));
+  TEST_MESSAGE(msg);
+}
+
+// ===================== 状態遷移（RelayServer → RelayClient） =====================
+// 変化した項目だけ送り、全量再送では同じ rev を送り直すが CLIENT は適用し直さない
+static void test_server_sends_deltas_and_keyframes() {
+  uint8_t buf[RELAY_MAX_PACKET];
+  RelayServer srv;
+  srv.epoch = 7;
+  CaptureHost sh;
+  RelayClient cl;
+  RecordHost ch;
+  sh.news.t[0] = makeTitles(3, 0);
+
+  srv.noteBtc(0); srv.noteRates(0); srv.noteNews(0, 0);
+  srv.pump(100, buf, sizeof buf, sh);
+  TEST_ASSERT_EQUAL_UINT32(3, sh.out.size()); // BTC, RATES, NEWS（ハートビートはまだ）
+  TEST_ASSERT_EQUAL_INT(3, deliver(cl, ch, sh.out, 100));
+  TEST_ASSERT_TRUE(ch.btc == 15000000.0);
+  TEST_ASSERT_EQUAL_STRING("USD/JPY 150.00", ch.rates.c_str());
+  TEST_ASSERT_TRUE(ch.shown[0] == sh.news.t[0]);
+
+  sh.out.clear();
+  srv.pump(RELAY_HEARTBEAT_MS, buf, sizeof buf, sh); // 変化なし → ハートビートだけ
+  TEST_ASSERT_EQUAL_UINT32(1, sh.out.size());
+  TEST_ASSERT_EQUAL_INT(0, deliver(cl, ch, sh.out, RELAY_HEARTBEAT_MS));
+  TEST_ASSERT_EQUAL_UINT32(0, cl.behindSince);
+
+  sh.out.clear();
+  sh.btc = 16000000.0;
+  srv.noteBtc(RELAY_HEARTBEAT_MS + 10);
+  srv.pump(RELAY_HEARTBEAT_MS + 20, buf, sizeof buf, sh);
+  TEST_ASSERT_EQUAL_UINT32(1, sh.out.size());
+  TEST_ASSERT_EQUAL_INT(1, deliver(cl, ch, sh.out, RELAY_HEARTBEAT_MS + 20));
+  TEST_ASSERT_TRUE(ch.btc == 16000000.0);
+
+  sh.out.clear();
+  srv.pump(RELAY_KEYFRAME_MS, buf, sizeof buf, sh); // 全量再送 + ハートビート
+  TEST_ASSERT_EQUAL_UINT32(4, sh.out.size());
+  TEST_ASSERT_EQUAL_INT(0, deliver(cl, ch, sh.out, RELAY_KEYFRAME_MS));
+  TEST_ASSERT_EQUAL_UINT32(1, ch.commits);
+  TEST_ASSERT_TRUE(cl.live(RELAY_KEYFRAME_MS));
+}
+
+// SERVER の再起動で rev が 0 から数え直されても、epoch の変化で取り込み直す
+// （epoch がないと、再起動後の rev 1 が適用済みの rev 1 と衝突して捨てられる。v2 の不具合の再現）
+static void test_epoch_change_resets_revs() {
+  uint8_t buf[RELAY_MAX_PACKET];
+  RelayClient cl;
+  RecordHost ch;
+  CaptureHost sh;
+  RelayServer a;
+  a.epoch = 111;
+  for (int i = 0; i < 3; i++) { a.noteBtc(0); sh.btc = 1.0 + i; a.pump(0, buf, sizeof buf, sh); }
+  TEST_ASSERT_EQUAL_INT(3, deliver(cl, ch, sh.out, 0));
+  TEST_ASSERT_EQUAL_UINT32(3, cl.btcRev);
+
+  sh.out.clear();
+  RelayServer b; // 再起動
+  b.epoch = 222;
+  for (int i = 0; i < 3; i++) { b.noteBtc(0); sh.btc = 10.0 + i; b.pump(0, buf, sizeof buf, sh); }
+  TEST_ASSERT_EQUAL_INT(3, deliver(cl, ch, sh.out, 0)); // rev 1〜3 を再び適用
+  TEST_ASSERT_TRUE(ch.btc == 12.0);
+  TEST_ASSERT_EQUAL_UINT32(1, ch.resyncs);
+  TEST_ASSERT_EQUAL_UINT32(222, cl.epoch);
+}
+
+// ハートビートが先へ進んだら、受信途中の古い NEWS は捨てる（表示中の見出しはそのまま）
+static void test_heartbeat_drops_stale_partial_news() {
+  uint8_t buf[RELAY_MAX_PACKET];
+  RelayServer srv;
+  srv.epoch = 5;
+  CaptureHost sh;
+  RelayClient cl;
+  RecordHost ch;
+  sh.news.t[0] = makeTitles(24, 9);
+  srv.noteNews(0, 0);
+  srv.pump(0, buf, sizeof buf, sh);
+  TEST_ASSERT_TRUE(sh.out.size() >= 2);
+  deliver(cl, ch, sh.out, 0, 0, 1); // 先頭の分割だけ
+  TEST_ASSERT_EQUAL_UINT32(1, cl.newsPendRev[0]);
+  TEST_ASSERT_FALSE(ch.staged[0].empty());
+
+  sh.out.clear();
+  srv.noteNews(0, 1000);
+  srv.lastHb = 0;
+  srv.pump(RELAY_HEARTBEAT_MS, buf, sizeof buf, sh);
+  deliver(cl, ch, sh.out, RELAY_HEARTBEAT_MS, sh.out.size() - 1); // 新しい rev の本体は落ち、ハートビートだけ届く
+  TEST_ASSERT_EQUAL_UINT32(0, cl.newsPendRev[0]);
+  TEST_ASSERT_EQUAL_UINT32(1, ch.aborts);
+  TEST_ASSERT_TRUE(ch.staged[0].empty());
+  TEST_ASSERT_TRUE(ch.shown[0].empty());
+  TEST_ASSERT_EQUAL_UINT32(0, ch.commits);
+}
+
+// 分割の途中が欠け続けると、ハートビートが届いていても RELAY_BEHIND_MS で直接取得へ。
+// 次の全量再送が揃えば追いつき、live に戻る
+static void test_missing_part_falls_back_then_recovers() {
+  uint8_t buf[RELAY_MAX_PACKET];
+  RelayServer srv;
+  srv.epoch = 9;
+  CaptureHost sh;
+  RelayClient cl;
+  RecordHost ch;
+  cl.start(0);
+  sh.news.t[1] = makeTitles(24, 3);
+  srv.noteNews(1, 0);
+
+  uint32_t t = 0, fellBackAt = 0;
+  bool dropped = false;
+  for (; t <= RELAY_KEYFRAME_MS * 4; t += 1000) {
+    sh.out.clear();
+    srv.pump(t, buf, sizeof buf, sh);
+    for (size_t i = 0; i < sh.out.size(); i++) {
+      RelayMsg m;
+      TEST_ASSERT_TRUE(relayDecode(sh.out[i].data(), sh.out[i].size(), m));
+      // 最初の2回（初回送信と1回目の全量再送）は分割 1 を落とす
+      if (m.type == RELAY_T_NEWS && m.part == 1 && t < RELAY_KEYFRAME_MS * 2) { dropped = true; continue; }
+      cl.onPacket(m, t, ch);
+    }
+    if (!fellBackAt && !cl.live(t)) fellBackAt = t;
+    if (t >= RELAY_KEYFRAME_MS * 2) break;
+  }
+  TEST_ASSERT_TRUE(dropped);
+  TEST_ASSERT_TRUE(fellBackAt > 0);
+  // 遅れ始め = 最初のハートビート（RELAY_HEARTBEAT_MS）。その RELAY_BEHIND_MS 後を過ぎた最初の周回で落ちる
+  TEST_ASSERT_EQUAL_UINT32(RELAY_HEARTBEAT_MS + RELAY_BEHIND_MS + 1000, fellBackAt);
+  TEST_ASSERT_TRUE(ch.aborts >= 2);
+  TEST_ASSERT_TRUE(ch.shown[1] == sh.news.t[1]); // 2回目の全量再送で揃った
+  TEST_ASSERT_EQUAL_UINT32(1, cl.newsRev[1]);
+
+  // 次のハートビートで遅れが解消
+  t += RELAY_HEARTBEAT_MS;
+  sh.out.clear();
+  srv.pump(t, buf, sizeof buf, sh);
+  deliver(cl, ch, sh.out, t);
+  TEST_ASSERT_EQUAL_UINT32(0, cl.behindSince);
+  TEST_ASSERT_TRUE(cl.live(t));
+}
+
+// ===================== 1時間の模擬 =====================
+// main.cpp の NetTask と同じ取得判定（リレーが生きている CLIENT は取得しない。
+// 取得しなかった周回では前回時刻を進めないので、フォールバックした周回で即取得する）
+struct FetchSchedule {
+  static const uint32_t BTC_MS = 10 * 1000, RSS_MS = 60 * 1000, RATES_MS = 5 * 60 * 1000;
+  uint32_t lastBtc, lastRss, lastRates;
+  uint32_t reqs = 0;
+
+  explicit FetchSchedule(uint32_t now) : lastBtc(now - BTC_MS), lastRss(now - RSS_MS), lastRates(now - RATES_MS) {}
+  // 取得した項目のビット（1=BTC, 2=RSS, 4=RATES）
+  int step(uint32_t now) {
+    int got = 0;
+    if (now - lastBtc >= BTC_MS)     { lastBtc = now;   reqs += 1;            got |= 1; }
+    if (now - lastRss >= RSS_MS)     { lastRss = now;   reqs += RELAY_FEEDS; got |= 2; }
+    if (now - lastRates >= RATES_MS) { lastRates = now; reqs += 1;            got |= 4; }
+    return got;
+  }
+};
+
+static void test_simulated_hour_reduces_upstream_requests() {
+  Loopback lb;
+  if (!lb.open()) { lb.close(); TEST_IGNORE_MESSAGE("multicast loopback unavailable"); }
+
+  const uint32_t STEP_MS = 1000, HOUR_MS = 3600 * 1000;
+  const uint32_t DOWN_AT = HOUR_MS / 2, DOWN_MS = 90 * 1000; // 途中で SERVER が 90秒止まって再起動（rev は 0 から）
+
+  uint8_t buf[RELAY_MAX_PACKET];
+  RelayServer   srv;
+  srv.epoch = 0x1234567u;
+  CaptureHost   sh;
+  FetchSchedule sf(0);
+  uint32_t serverReqs = 0, deltas = 0, packets = 0, lastSentAt = 0;
+
+  RelayClient   cl[RECEIVERS];
+  RecordHost    ch[RECEIVERS];
+  FetchSchedule cf[RECEIVERS] = {FetchSchedule(0), FetchSchedule(0), FetchSchedule(0), FetchSchedule(0)};
+  uint32_t applied[RECEIVERS] = {}, fallbackFirst = 0, fallbackLast = 0;
+  for (int r = 0; r < RECEIVERS; r++) cl[r].start(0);
+
+  for (uint32_t t = 0; t < HOUR_MS; t += STEP_MS) {
+    const bool down = (t >= DOWN_AT && t < DOWN_AT + DOWN_MS);
+    sh.out.clear();
+    if (!down) {
+      if (t == DOWN_AT + DOWN_MS) { // 再起動：状態も取得予定も初期化
+        serverReqs += sf.reqs;
+        srv = RelayServer(); srv.epoch = 0x89ABCDEu;
+        sf = FetchSchedule(t);
+      }
+      int got = sf.step(t);
+      if (got & 1) { sh.btc = 15000000.0 + t / 1000; srv.noteBtc(t); deltas++; }
+      if (got & 4) { sh.rates = "USD/JPY " + std::to_string(t / 1000); srv.noteRates(t); deltas++; }
+      if (got & 2)
+        for (int f = 0; f < RELAY_FEEDS; f++) { sh.news.t[f] = makeTitles(24, (int)(t / 1000) + f); srv.noteNews(f, t); deltas++; }
+      srv.pump(t, buf, sizeof buf, sh);
+    }
+
+    for (size_t i = 0; i < sh.out.size(); i++) TEST_ASSERT_TRUE(lb.send(sh.out[i].data(), sh.out[i].size()));
+    packets += sh.out.size();
+    if (!sh.out.empty() && t < DOWN_AT) lastSentAt = t;
+    for (int r = 0; r < RECEIVERS; r++) {
+      for (size_t i = 0; i < sh.out.size(); i++) {
+        int len = lb.recv(r, buf, sizeof buf, 200);
+        RelayMsg m;
+        TEST_ASSERT_TRUE_MESSAGE(len > 0 && relayDecode(buf, (size_t)len, m), "packet lost on loopback");
+        if (cl[r].onPacket(m, t, ch[r])) applied[r]++;
+      }
+      // NetTask と同じく、リレーが生きていなければ直接取得
+      if (!cl[r].live(t) && cf[r].step(t)) {
+        if (!fallbackFirst) fallbackFirst = t;
+        fallbackLast = t;
+      }
+    }
+  }
+  lb.close();
+  serverReqs += sf.reqs;
+
+  uint32_t clientReqs = 0;
+  for (int r = 0; r < RECEIVERS; r++) {
+    clientReqs += cf[r].reqs;
+    TEST_ASSERT_EQUAL_UINT32(srv.btcRev, cl[r].btcRev);
+    TEST_ASSERT_EQUAL_UINT32(srv.ratesRev, cl[r].ratesRev);
+    for (int f = 0; f < RELAY_FEEDS; f++) {
+      TEST_ASSERT_EQUAL_UINT32(srv.newsRev[f], cl[r].newsRev[f]);
+      TEST_ASSERT_TRUE(ch[r].shown[f] == sh.news.t[f]);
+    }
+    TEST_ASSERT_TRUE(ch[r].btc == sh.btc);
+    TEST_ASSERT_EQUAL_STRING(sh.rates.c_str(), ch[r].rates.c_str());
+    TEST_ASSERT_EQUAL_UINT32(deltas, applied[r]);
+    TEST_ASSERT_EQUAL_UINT32(1, ch[r].resyncs);
+    TEST_ASSERT_EQUAL_UINT32(0, ch[r].aborts);
+  }
+  // 直接取得は SERVER 停止中（最後の受信から無音が RELAY_SILENCE_MS 続いてから再開まで）だけ
+  TEST_ASSERT_EQUAL_UINT32(lastSentAt + RELAY_SILENCE_MS, fallbackFirst);
+  TEST_ASSERT_TRUE(fallbackLast < DOWN_AT + DOWN_MS);
+  TEST_ASSERT_TRUE(clientReqs > 0);
+
+  // 比較用：全台が直接取得した場合（同じスケジュールを1時間）
+  FetchSchedule alone(0);
+  for (uint32_t t = 0; t < HOUR_MS; t += STEP_MS) alone.step(t);
+  const uint32_t direct = alone.reqs * (RECEIVERS + 1);
+  const uint32_t relayed = serverReqs + clientReqs;
+
+  char msg[240];
+  snprintf(msg, sizeof msg,
+           "1h, 1 server + %d clients, %us server outage: upstream requests %u with relay "
+           "(server %u + client fallback %u) vs %u direct (%.2fx fewer); %u relay packets, %u deltas applied per client",
+           RECEIVERS, DOWN_MS / 1000, relayed, serverReqs, clientReqs, direct, (double)direct / relayed,
+           packets, applied[0]);
+  TEST_MESSAGE(msg);
+}
+
+int main(int, char**) {
+  UNITY_BEGIN();
+  RUN_TEST(test_roundtrip_all_types);
+  RUN_TEST(test_decode_rejects_bad_packets);
+  RUN_TEST(test_server_sends_deltas_and_keyframes);
+  RUN_TEST(test_epoch_change_resets_revs);
+  RUN_TEST(test_heartbeat_drops_stale_partial_news);
+  RUN_TEST(test_missing_part_falls_back_then_recovers);
+  RUN_TEST(test_loopback_transit_latency);
+  RUN_TEST(test_simulated_hour_reduces_upstream_requests);
+  return UNITY_END();
+}
@@ -0,0 +1,160 @@
+// RleLayer.h のホストテスト（pio test -e native -f test_rle_layer）
+//   - rleEncode → rleDecode の往復がすべての画素で LUT(元のパレット番号) に戻ること
+//   - ラン長の上限（16px）・行末・幅1 などの境界
+//   - 画面風の 320x240 画像で圧縮後サイズと1画面の展開時間を出力する
+#include <unity.h>
+#include <stdio.h>
+#include <time.h>
+#include <vector>
+#include <random>
+#include "RleLayer.h"
+
+void setUp() {}
+void tearDown() {}
+
+static double nowNs() {
+  struct timespec ts;
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  return ts.tv_sec * 1e9 + ts.tv_nsec;
+}
+
+// パレット番号ごとに別の値（上位バイトも使う）
+static uint16_t LUT[16];
+static void initLut() {
+  for (int i = 0; i < 16; i++) LUT[i] = (uint16_t)(0x1001 * (i + 1) ^ (i << 7));
+}
+
+struct Img {
+  uint16_t w, h;
+  std::vector<uint8_t> px;
+  Img(uint16_t w_, uint16_t h_) : w(w_), h(h_), px((size_t)w_ * h_) {}
+  uint8_t& at(int x, int y) { return px[(size_t)y * w + x]; }
+};
+
+// 往復して全画素を照合。戻り値 = 圧縮後バイト数
+static uint32_t roundTrip(Img& im) {
+  RleImage r;
+  TEST_ASSERT_TRUE(rleEncode(r, im.w, im.h, [&](uint16_t x, uint16_t y) { return im.at(x, y); }));
+  TEST_ASSERT_EQUAL_UINT32(im.w, r.w);
+  TEST_ASSERT_EQUAL_UINT32(im.h, r.h);
+  std::vector<uint16_t> line(im.w + 1, 0xDEAD);
+  int rows = 0;
+  rleDecode(r, LUT, line.data(), [&](uint16_t y, const uint16_t* l) {
+    TEST_ASSERT_EQUAL_UINT32(rows, y);
+    for (int x = 0; x < im.w; x++) {
+      if (l[x] != LUT[im.at(x, y)]) {
+        char msg[64];
+        snprintf(msg, sizeof msg, "pixel (%d,%d)", x, (int)y);
+        TEST_FAIL_MESSAGE(msg);
+      }
+    }
+    TEST_ASSERT_EQUAL_UINT16(0xDEAD, l[im.w]); // 行末を越えて書かない
+    rows++;
+  });
+  TEST_ASSERT_EQUAL_INT(im.h, rows);
+  uint32_t n = r.size;
+  r.release();
+  TEST_ASSERT_FALSE(r.valid());
+  return n;
+}
+
+static void test_run_length_limits() {
+  // 1色ベタ：1行 320px = 16px × 20ラン
+  Img flat(320, 4);
+  TEST_ASSERT_EQUAL_UINT32(4 * 20, roundTrip(flat));
+
+  // 15 / 16 / 17 / 32 / 33px のランと、行をまたいで続く同色
+  const int lens[] = {15, 16, 17, 32, 33};
+  for (size_t k = 0; k < sizeof(lens) / sizeof(lens[0]); k++) {
+    Img im((uint16_t)(lens[k] + 1), 2);
+    for (int x = 0; x < lens[k]; x++) { im.at(x, 0) = 5; im.at(x, 1) = 5; }
+    im.at(lens[k], 0) = 9; im.at(lens[k], 1) = 5; // 2行目は行末まで同色（行をまたがず切れる）
+    uint32_t runs = (uint32_t)((lens[k] + 15) / 16);
+    uint32_t row2 = (uint32_t)((lens[k] + 1 + 15) / 16);
+    TEST_ASSERT_EQUAL_UINT32(runs + 1 + row2, roundTrip(im));
+  }
+
+  // 幅1 / 市松（1px ラン）
+  Img col(1, 7);
+  for (int y = 0; y < 7; y++) col.at(0, y) = (uint8_t)(y & 15);
+  TEST_ASSERT_EQUAL_UINT32(7, roundTrip(col));
+  Img chk(31, 9);
+  for (int y = 0; y < 9; y++) for (int x = 0; x < 31; x++) chk.at(x, y) = (uint8_t)((x + y) & 1 ? 15 : 0);
+  TEST_ASSERT_EQUAL_UINT32(31 * 9, roundTrip(chk));
+}
+
+static void test_random_images_roundtrip() {
+  std::mt19937 rng(3);
+  for (int it = 0; it < 300; it++) {
+    Img im((uint16_t)(1 + rng() % 64), (uint16_t)(1 + rng() % 16));
+    uint8_t c = 0;
+    for (size_t i = 0; i < im.px.size(); i++) {
+      if (rng() % 8 == 0) c = (uint8_t)(rng() % 16); // 平均 8px のラン
+      im.px[i] = c;
+    }
+    roundTrip(im);
+  }
+}
+
+// 画面風の画像：背景ベタ + 帯 + 枠線 + 文字（細かいノイズ）
+static void makePage(Img& im) {
+  std::mt19937 rng(4);
+  for (int y = 0; y < im.h; y++)
+    for (int x = 0; x < im.w; x++) {
+      uint8_t c = 0;
+      if (y < 23) c = 1;                                         // ヘッダー帯
+      if (y == 23 || (y > 24 && (y - 24) % 72 == 0)) c = 2;     // 区切り線
+      if (x < 5 && y > 24) c = (uint8_t)(3 + (y - 24) / 72);    // 左バー
+      bool text = (y >= 4 && y < 20 && x >= 84 && x < 324 - 84) ||
+                  (y >= 40 && y < 56 && x >= 20 && x < 200) ||
+                  (y >= 112 && y < 128 && x >= 20 && x < 200) ||
+                  (y >= 184 && y < 200 && x >= 20 && x < 200);
+      if (text && rng() % 3 == 0) c = 7;                         // 文字っぽい細かい模様
+      im.at(x, y) = c;
+    }
+}
+
+static void test_bench_page_decode() {
+  Img page(320, 240);
+  makePage(page);
+  uint32_t bytes = roundTrip(page);
+
+  RleImage r;
+  TEST_ASSERT_TRUE(rleEncode(r, 320, 240, [&](uint16_t x, uint16_t y) { return page.at(x, y); }));
+  static uint16_t frame[320 * 240];
+  uint16_t line[320];
+  const int N = 200;
+  double t0 = nowNs();
+  for (int i = 0; i < N; i++)
+    rleDecode(r, LUT, line, [&](uint16_t y, const uint16_t* l) { memcpy(frame + y * 320, l, sizeof(line)); });
+  double us = (nowNs() - t0) / N / 1000.0;
+
+  // 比較：4bit 生データ（2px/B）を LUT で展開
+  std::vector<uint8_t> raw(320 * 240 / 2);
+  for (size_t i = 0; i < raw.size(); i++) raw[i] = (uint8_t)(page.px[2 * i] | (page.px[2 * i + 1] << 4));
+  t0 = nowNs();
+  for (int i = 0; i < N; i++)
+    for (int y = 0; y < 240; y++) {
+      const uint8_t* p = &raw[y * 160];
+      for (int x = 0; x < 160; x++) { line[2 * x] = LUT[p[x] & 15]; line[2 * x + 1] = LUT[p[x] >> 4]; }
+      memcpy(frame + y * 320, line, sizeof(line));
+    }
+  double rawUs = (nowNs() - t0) / N / 1000.0;
+  r.release();
+
+  TEST_ASSERT_TRUE(bytes < 320 * 240 / 2);
+  char msg[200];
+  snprintf(msg, sizeof msg,
+           "320x240 page: RLE %u B (4bit raw %u B); decode to RGB565 %.1f us/frame (raw 4bit expand %.1f us)",
+           (unsigned)bytes, 320u * 240u / 2, us, rawUs);
+  TEST_MESSAGE(msg);
+}
+
+int main(int, char**) {
+  initLut();
+  UNITY_BEGIN();
+  RUN_TEST(test_run_length_limits);
+  RUN_TEST(test_random_images_roundtrip);
+  RUN_TEST(test_bench_page_decode);
+  return UNITY_END();
+}
@@ -0,0 +1,157 @@
+// SensorStats.h のホストテスト（pio test -e native -f test_sensor_stats）
+//   - RollingWindow の min/max/mean/n を総当たりの窓と突き合わせる（空白期間・巻き戻りを含む）
+//   - SensorSeries::add の所要時間とウィンドウごとの sizeof を出力する
+#include <unity.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <math.h>
+#include <time.h>
+#include <vector>
+#include "SensorStats.h"
+
+void setUp() {}
+void tearDown() {}
+
+struct Sample { uint32_t t; float v; };
+
+// 総当たり：バケット番号が (現在 - (N-1)) .. 現在 のサンプルを全部なめる
+template <uint8_t N>
+static bool bruteStats(const std::vector<Sample>& xs, uint32_t bucketMs, WindowStats& out) {
+  if (xs.empty()) return false;
+  const uint32_t cur = xs.back().t / bucketMs;
+  double sum = 0; uint32_t n = 0;
+  float mn = INFINITY, mx = -INFINITY;
+  for (size_t i = 0; i < xs.size(); i++) {
+    uint32_t seq = xs[i].t / bucketMs;
+    if (cur - seq > (uint32_t)(N - 1)) continue;
+    sum += xs[i].v; n++;
+    if (xs[i].v < mn) mn = xs[i].v;
+    if (xs[i].v > mx) mx = xs[i].v;
+  }
+  if (n == 0) return false;
+  out.min = mn; out.max = mx; out.mean = (float)(sum / n); out.n = n;
+  return true;
+}
+
+template <uint8_t N>
+static void checkAgainstBrute(uint32_t bucketMs, unsigned seed, int steps) {
+  srand(seed);
+  RollingWindow<N> w(bucketMs);
+  std::vector<Sample> xs;
+  uint32_t t = 1000;
+  uint32_t prev = t;
+  float v = 20.0f;
+  for (int i = 0; i < steps; i++) {
+    int r = rand() % 100;
+    if (r < 2)       t += bucketMs * (N + rand() % 8);      // ウィンドウより長い空白
+    else if (r < 10) t += bucketMs * (1 + rand() % (N / 2)); // 途中が空くだけの空白
+    else             t += rand() % (bucketMs / 2 + 1);
+    v += (rand() % 201 - 100) / 100.0f;
+    if (t < prev) xs.clear(); // millis() が一周 = 巻き戻り扱いでリセット
+    prev = t;
+    w.add(t, v);
+    xs.push_back({t, v});
+
+    WindowStats a, b;
+    bool okA = w.stats(a);
+    bool okB = bruteStats<N>(xs, bucketMs, b);
+    TEST_ASSERT_EQUAL(okB, okA);
+    TEST_ASSERT_EQUAL_UINT32(b.n, a.n);
+    TEST_ASSERT_FLOAT_WITHIN(1e-3f, b.min, a.min);
+    TEST_ASSERT_FLOAT_WITHIN(1e-3f, b.max, a.max);
+    TEST_ASSERT_FLOAT_WITHIN(1e-3f, b.mean, a.mean);
+  }
+}
+
+static void test_window_matches_brute_force() {
+  checkAgainstBrute<2>(1000, 1, 3000);
+  checkAgainstBrute<30>(10 * 1000, 2, 5000);
+  checkAgainstBrute<60>(60 * 1000, 3, 5000);
+  checkAgainstBrute<96>(15 * 60 * 1000, 4, 5000);
+}
+
+static void test_gap_longer_than_window_keeps_only_current() {
+  RollingWindow<30> w(10 * 1000);
+  for (uint32_t t = 0; t < 300 * 1000; t += 1000) w.add(t, 5.0f);
+  w.add(10 * 60 * 1000, 9.0f);
+  WindowStats s;
+  TEST_ASSERT_TRUE(w.stats(s));
+  TEST_ASSERT_EQUAL_UINT32(1, s.n);
+  TEST_ASSERT_EQUAL_FLOAT(9.0f, s.min);
+  TEST_ASSERT_EQUAL_FLOAT(9.0f, s.max);
+}
+
+static void test_time_rewind_resets() {
+  RollingWindow<30> w(10 * 1000);
+  for (uint32_t t = 100000; t < 200000; t += 1000) w.add(t, 1.0f);
+  w.add(5000, 3.0f);
+  WindowStats s;
+  TEST_ASSERT_TRUE(w.stats(s));
+  TEST_ASSERT_EQUAL_UINT32(1, s.n);
+  TEST_ASSERT_EQUAL_FLOAT(3.0f, s.mean);
+}
+
+static void test_nan_ignored() {
+  RollingWindow<30> w(10 * 1000);
+  WindowStats s;
+  w.add(0, NAN);
+  TEST_ASSERT_FALSE(w.stats(s));
+  w.add(1000, 2.0f);
+  w.add(2000, NAN);
+  TEST_ASSERT_TRUE(w.stats(s));
+  TEST_ASSERT_EQUAL_UINT32(1, s.n);
+}
+
+static void test_pressure_delta_3h() {
+  SensorSeries p;
+  // 1分ごと、4時間で 1000 → 1004 hPa（3時間で +3）
+  for (uint32_t m = 0; m <= 240; m++) p.add(m * 60 * 1000, 1000.0f + m / 60.0f);
+  float d = pressureDelta3h(p);
+  TEST_ASSERT_FLOAT_WITHIN(0.3f, 3.0f, d);
+  TEST_ASSERT_EQUAL(PT_RISING, classifyPressureTrend(d));
+}
+
+static double nowSec() {
+  struct timespec ts;
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  return ts.tv_sec + ts.tv_nsec * 1e-9;
+}
+
+static void test_bench_series_add() {
+  static SensorSeries s;
+  const int n = 2000000;
+  volatile float sink = 0;
+  double t0 = nowSec();
+  for (int i = 0; i < n; i++) s.add((uint32_t)i * 500u, 20.0f + (i % 97) * 0.01f); // 2Hz 相当
+  double dt = nowSec() - t0;
+  WindowStats st;
+  s.stats(WIN_24H, st);
+  sink = st.mean;
+  (void)sink;
+
+  char msg[160];
+  snprintf(msg, sizeof msg, "SensorSeries::add %.1f ns/sample (host, %d samples)", dt * 1e9 / n, n);
+  TEST_MESSAGE(msg);
+}
+
+static void test_report_sizes() {
+  char msg[160];
+  snprintf(msg, sizeof msg, "sizeof RollingWindow<30>=%u <60>=%u <96>=%u SensorSeries=%u",
+           (unsigned)sizeof(RollingWindow<30>), (unsigned)sizeof(RollingWindow<60>),
+           (unsigned)sizeof(RollingWindow<96>), (unsigned)sizeof(SensorSeries));
+  TEST_MESSAGE(msg);
+  // 1系列あたり約 4KB に収まること（コメントの見積もり (N-1)*(20+2)+α）
+  TEST_ASSERT_TRUE(sizeof(SensorSeries) < 4400);
+}
+
+int main(int, char**) {
+  UNITY_BEGIN();
+  RUN_TEST(test_window_matches_brute_force);
+  RUN_TEST(test_gap_longer_than_window_keeps_only_current);
+  RUN_TEST(test_time_rewind_resets);
+  RUN_TEST(test_nan_ignored);
+  RUN_TEST(test_pressure_delta_3h);
+  RUN_TEST(test_bench_series_add);
+  RUN_TEST(test_report_sizes);
+  return UNITY_END();
+}
@@ -0,0 +1,237 @@
+// StatusHttp.h のホストテスト（pio test -e native -f test_status_http）
+//   - serveStatusRequest を文字列 Sink に流し、JSON が構文として正しいこと・値とエスケープを確かめる
+//   - /metrics の全サンプルに # HELP / # TYPE が1組ずつ先行すること
+#include <unity.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <ctype.h>
+#include <string.h>
+#include <string>
+#include <set>
+#include "StatusHttp.h"
+
+void setUp() {}
+void tearDown() {}
+
+struct StrSink {
+  std::string s;
+  size_t writes = 0;
+  size_t write(const uint8_t* p, size_t n) { s.append((const char*)p, n); writes++; return n; }
+};
+
+// ===================== 最小 JSON 検査（構文のみ） =====================
+struct JsonCheck {
+  const char* p;
+  bool ok = true;
+  explicit JsonCheck(const char* s) : p(s) {}
+  void ws() { while (*p == ' ' || *p == '\n' || *p == '\r' || *p == '\t') p++; }
+  bool lit(const char* w) { size_t n = strlen(w); if (strncmp(p, w, n)) return false; p += n; return true; }
+  bool str() {
+    if (*p++ != '"') return false;
+    while (*p && *p != '"') {
+      if ((unsigned char)*p < 0x20) return false;
+      if (*p == '\\') {
+        p++;
+        if (*p == 'u') { for (int i = 1; i <= 4; i++) if (!isxdigit((unsigned char)p[i])) return false; p += 4; }
+        else if (!strchr("\"\\/bfnrt", *p)) return false;
+      }
+      p++;
+    }
+    return *p++ == '"';
+  }
+  bool num() {
+    char* e;
+    strtod(p, &e);
+    if (e == p) return false;
+    p = e; return true;
+  }
+  bool value() {
+    ws();
+    bool r;
+    if (*p == '{') {
+      p++; ws();
+      if (*p == '}') { p++; return true; }
+      do { ws(); if (!str()) return false; ws(); if (*p++ != ':') return false; if (!value()) return false; ws(); } while (*p == ',' && p++);
+      r = (*p++ == '}');
+    } else if (*p == '[') {
+      p++; ws();
+      if (*p == ']') { p++; return true; }
+      do { if (!value()) return false; ws(); } while (*p == ',' && p++);
+      r = (*p++ == ']');
+    } else if (*p == '"') r = str();
+    else r = lit("true") || lit("false") || lit("null") || num();
+    return r;
+  }
+  bool document() { bool r = value(); ws(); return r && *p == '\0'; }
+};
+
+static const char* const TITLES[SNAP_FEEDS][3] = {
+  {"Plain headline", "Quote \" and backslash \\ inside", "Line\nbreak\tand tab"},
+  {"Business one", nullptr, nullptr},
+  {nullptr, nullptr, nullptr},
+};
+
+static uint32_t gLiveRev[SNAP_FEEDS] = {3, 1, 0};
+static int      gCommitAfter = -1; // この件数を返した後にフィード 0 が差し替わる（-1 = なし）
+
+static bool fakeHeadline(int feed, uint32_t rev, int index, char* out, size_t outsz) {
+  if (gLiveRev[feed] != rev) return false;
+  if (index >= 3 || !TITLES[feed][index]) return false;
+  if (feed == 0 && index + 1 == gCommitAfter) gLiveRev[0]++;
+  snprintf(out, outsz, "%s", TITLES[feed][index]);
+  return true;
+}
+
+static void fillSnapshot(StatusSnapshot& s) {
+  s.uptimeMs = 1234567890; // 約14日（%g では桁が落ちる大きさ）
+  s.btc = 15234567; s.btcPrev = 15200000; s.btcRev = 9;
+  snprintf(s.ticker, sizeof s.ticker, "USD/JPY 150.12 \"x\"");
+  s.newsRev[0] = 3; s.newsRev[1] = 1;
+  s.newsCount[0] = 3; s.newsCount[1] = 1;
+  s.headline = fakeHeadline;
+  s.temp = 21.5f; // humid / pressure は NaN のまま → null
+  s.wifiOk = true; s.rssi = -61;
+  s.fetchOk[SRC_BTC] = 5; s.fetchFail[SRC_RATES] = 2;
+  s.powerMode = 1; s.brightness = 80;
+  s.clockSecOnly = 1234567; s.clockFull = 20576; s.clockDateUpd = 14;
+  s.powerSec[0] = 1000000.25;
+}
+
+static std::string body(const std::string& r) {
+  size_t k = r.find("\r\n\r\n");
+  return k == std::string::npos ? std::string() : r.substr(k + 4);
+}
+
+static void test_status_json() {
+  static StatusSnapshot s;
+  s = StatusSnapshot();
+  fillSnapshot(s);
+  StrSink sink;
+  serveStatusRequest(sink, "/status", s);
+
+  TEST_ASSERT_EQUAL_INT(0, sink.s.find("HTTP/1.1 200 OK\r\n"));
+  TEST_ASSERT_TRUE(sink.s.find("Content-Type: application/json\r\n") != std::string::npos);
+  std::string b = body(sink.s);
+  JsonCheck jc(b.c_str());
+  TEST_ASSERT_TRUE_MESSAGE(jc.document(), b.c_str());
+
+  TEST_ASSERT_TRUE(b.find("\"uptime_ms\":1234567890") != std::string::npos);
+  TEST_ASSERT_TRUE(b.find("\"jpy\":15234567") != std::string::npos);
+  TEST_ASSERT_TRUE(b.find("\"humidity_pct\":null") != std::string::npos);
+  TEST_ASSERT_TRUE(b.find("\"temperature_c\":21.50") != std::string::npos);
+  TEST_ASSERT_TRUE(b.find("\"rates\":\"USD/JPY 150.12 \\\"x\\\"\"") != std::string::npos);
+  TEST_ASSERT_TRUE(b.find("\"world\":{\"rev\":3,\"items\":[\"Plain headline\","
+                          "\"Quote \\\" and backslash \\\\ inside\","
+                          "\"Line\\nbreak\\u0009and tab\"],\"complete\":true}") != std::string::npos);
+  TEST_ASSERT_TRUE(b.find("\"tech\":{\"rev\":0,\"items\":[],\"complete\":true}") != std::string::npos);
+  TEST_ASSERT_TRUE(b.find("\"mode\":\"idle\"") != std::string::npos);
+  TEST_ASSERT_TRUE(b.find("\"wifi\":{\"connected\":true,\"rssi\":-61}") != std::string::npos);
+
+  // "/" も同じ内容。出力は固定長バッファ経由でまとめて書かれる
+  StrSink root;
+  serveStatusRequest(root, "/", s);
+  TEST_ASSERT_TRUE(root.s == sink.s);
+  TEST_ASSERT_TRUE(sink.writes < sink.s.size() / 128 + 2);
+}
+
+// 応答の途中で取得が確定（rev が進む）したら、旧 rev の先頭部分だけ出して complete:false
+static void test_status_json_stops_at_feed_commit() {
+  static StatusSnapshot s;
+  s = StatusSnapshot();
+  fillSnapshot(s);
+  gLiveRev[0] = s.newsRev[0];
+  gCommitAfter = 2;
+  StrSink sink;
+  serveStatusRequest(sink, "/status", s);
+  gCommitAfter = -1;
+  gLiveRev[0] = s.newsRev[0];
+
+  std::string b = body(sink.s);
+  JsonCheck jc(b.c_str());
+  TEST_ASSERT_TRUE_MESSAGE(jc.document(), b.c_str());
+  TEST_ASSERT_TRUE(b.find("\"world\":{\"rev\":3,\"items\":[\"Plain headline\","
+                          "\"Quote \\\" and backslash \\\\ inside\"],\"complete\":false}") != std::string::npos);
+  TEST_ASSERT_TRUE(b.find("\"business\":{\"rev\":1,\"items\":[\"Business one\"],\"complete\":true}") != std::string::npos);
+}
+
+static void test_metrics_help_and_type_per_sample() {
+  static StatusSnapshot s;
+  s = StatusSnapshot();
+  fillSnapshot(s);
+  StrSink sink;
+  serveStatusRequest(sink, "/metrics", s);
+  TEST_ASSERT_TRUE(sink.s.find("Content-Type: text/plain; version=0.0.4\r\n") != std::string::npos);
+  std::string b = body(sink.s);
+
+  std::set<std::string> help, type, seen;
+  size_t pos = 0, samples = 0;
+  while (pos < b.size()) {
+    size_t e = b.find('\n', pos);
+    TEST_ASSERT_TRUE_MESSAGE(e != std::string::npos, "last line not terminated");
+    std::string line = b.substr(pos, e - pos);
+    pos = e + 1;
+    if (line.compare(0, 7, "# HELP ") == 0) {
+      std::string n = line.substr(7, line.find(' ', 7) - 7);
+      TEST_ASSERT_TRUE_MESSAGE(help.insert(n).second, line.c_str());
+      continue;
+    }
+    if (line.compare(0, 7, "# TYPE ") == 0) {
+      std::string n = line.substr(7, line.find(' ', 7) - 7);
+      TEST_ASSERT_TRUE_MESSAGE(help.count(n), ("TYPE before HELP: " + line).c_str());
+      TEST_ASSERT_TRUE_MESSAGE(type.insert(n).second, line.c_str());
+      std::string t = line.substr(8 + n.size());
+      TEST_ASSERT_TRUE_MESSAGE(t == "gauge" || t == "counter", line.c_str());
+      continue;
+    }
+    TEST_ASSERT_TRUE_MESSAGE(line.compare(0, 9, "okiclock_") == 0, line.c_str());
+    size_t ne = line.find_first_of("{ ");
+    std::string n = line.substr(0, ne);
+    TEST_ASSERT_TRUE_MESSAGE(help.count(n), ("sample without HELP: " + line).c_str());
+    TEST_ASSERT_TRUE_MESSAGE(type.count(n), ("sample without TYPE: " + line).c_str());
+    std::string v = line.substr(line.rfind(' ') + 1);
+    char* end;
+    strtod(v.c_str(), &end);
+    TEST_ASSERT_TRUE_MESSAGE(*end == '\0', line.c_str());
+    seen.insert(n);
+    samples++;
+  }
+  TEST_ASSERT_EQUAL_UINT32(help.size(), seen.size()); // HELP だけでサンプルのない系列がない
+  TEST_ASSERT_TRUE(b.find("okiclock_headline_count{feed=\"world\"} 3\n") != std::string::npos);
+  TEST_ASSERT_TRUE(b.find("okiclock_fetch_success_total{source=\"btc\"} 5\n") != std::string::npos);
+  TEST_ASSERT_TRUE(b.find("okiclock_humidity_percent NaN\n") != std::string::npos);
+  // 1e6 を超える値も桁を落とさない
+  TEST_ASSERT_TRUE(b.find("okiclock_uptime_seconds 1234567\n") != std::string::npos);
+  TEST_ASSERT_TRUE(b.find("okiclock_clock_text_sec_only_total 1234567\n") != std::string::npos);
+  TEST_ASSERT_TRUE(b.find("okiclock_clock_text_date_total 14\n") != std::string::npos);
+  TEST_ASSERT_TRUE(b.find("okiclock_btc_jpy 15234567\n") != std::string::npos);
+  TEST_ASSERT_TRUE(b.find("okiclock_power_mode_seconds_total{mode=\"active\"} 1000000.25\n") != std::string::npos);
+  TEST_ASSERT_TRUE(b.find("okiclock_temperature_celsius 21.5\n") != std::string::npos);
+  TEST_ASSERT_TRUE(b.find("okiclock_wifi_rssi_dbm -61\n") != std::string::npos);
+  TEST_ASSERT_TRUE(b.find("e+") == std::string::npos);
+
+  char msg[96];
+  snprintf(msg, sizeof msg, "/metrics: %u series, %u samples, %u bytes",
+           (unsigned)seen.size(), (unsigned)samples, (unsigned)b.size());
+  TEST_MESSAGE(msg);
+}
+
+static void test_not_found_and_path_parse() {
+  static StatusSnapshot s;
+  StrSink sink;
+  serveStatusRequest(sink, "/nope", s);
+  TEST_ASSERT_EQUAL_INT(0, sink.s.find("HTTP/1.1 404 Not Found\r\n"));
+
+  char path[32];
+  TEST_ASSERT_TRUE(httpParseGetPath("GET /metrics?x=1 HTTP/1.1", path, sizeof path));
+  TEST_ASSERT_EQUAL_STRING("/metrics", path);
+  TEST_ASSERT_FALSE(httpParseGetPath("POST / HTTP/1.1", path, sizeof path));
+}
+
+int main(int, char**) {
+  UNITY_BEGIN();
+  RUN_TEST(test_status_json);
+  RUN_TEST(test_status_json_stops_at_feed_commit);
+  RUN_TEST(test_metrics_help_and_type_per_sample);
+  RUN_TEST(test_not_found_and_path_parse);
+  return UNITY_END();
+}